@@ -5,7 +5,8 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -20,25 +21,22 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class CollisionDetectionController : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class CollisionDetectionController : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
   ros::Time start_time_;
 
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
 
 };
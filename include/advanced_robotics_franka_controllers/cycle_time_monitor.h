@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <franka_hw/trigger_rate.h>
+#include <realtime_tools/realtime_publisher.h>
+#include <ros/node_handle.h>
+#include <ros/time.h>
+#include <std_msgs/Float64MultiArray.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// Measures how long update() takes and how regularly it is called.
+// begin()/end() are real-time safe and bracket every update; the statistics
+// are published on ~cycle_time at a low rate and printed by dump().
+//
+// Parameters (controller namespace):
+//   cycle_time_budget       execution time budget in seconds   (0.0008)
+//   cycle_time_publish_rate publish rate in Hz, 0 disables it  (1.0)
+//
+// cycle_time message layout, times in microseconds:
+//   [count, overruns, budget, last, mean, max, max_jitter, histogram...]
+class CycleTimeMonitor
+{
+ public:
+  static constexpr size_t kBins = 40;
+  static constexpr double kBinWidth = 50.0;  // us
+
+  void init(ros::NodeHandle &node_handle);
+  void reset();
+
+  void begin(const ros::Duration &period);
+  void end();
+
+  void dump() const;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  void publish();
+
+  std::string name_;
+  double budget_{800.0};
+
+  Clock::time_point entry_;
+  Clock::time_point last_entry_;
+  bool has_last_entry_{false};
+
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> overruns_{0};
+  double last_{0.0};
+  double sum_{0.0};
+  double max_{0.0};
+  double max_jitter_{0.0};
+  std::array<std::atomic<uint64_t>, kBins> histogram_;
+
+  bool publish_enabled_{false};
+  franka_hw::TriggerRate publish_rate_{1.0};
+  realtime_tools::RealtimePublisher<std_msgs::Float64MultiArray> publisher_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Dense>
+
+namespace advanced_robotics_franka_controllers {
+
+// Damped least squares inverses of a fixed size, full row rank task jacobian
+// (Rows <= Cols, e.g. 6x7; a Matrix or a Map of one). Everything stays on
+// the stack.
+//
+// damping is the lambda^2 added to the singular values squared:
+//   J^# = J^T (J J^T + damping I)^-1 = V diag(s / (s^2 + damping)) U^T
+// dampedPseudoInverse(J, 0.001, J_pinv) is the
+//   J.transpose() * (J * J.transpose() + I * 0.001).inverse()
+// the task space controllers used to write out.
+
+// Cholesky (LLT) of J J^T + damping I, which is positive definite for any
+// damping > 0; the cheapest, use it in update().
+template <typename Derived, int Rows = Derived::RowsAtCompileTime, int Cols = Derived::ColsAtCompileTime>
+void dampedPseudoInverse(const Eigen::MatrixBase<Derived> &J, double damping,
+                         Eigen::Matrix<double, Cols, Rows> &J_pinv)
+{
+  static_assert(Rows <= Cols, "the task must not have more rows than joints");
+  Eigen::Matrix<double, Rows, Rows> JJt = J * J.transpose();
+  JJt.diagonal().array() += damping;
+  J_pinv = JJt.llt().solve(J).transpose();
+}
+
+// Thin SVD version, an order of magnitude slower. The SVD works on a matrix of
+// dynamic size but fixed maximum size, which is what lets Eigen compute the
+// thin factors, so nothing is allocated. The Rows columns of V are scaled by
+// the damped singular values without forming S. With damping = 0 it is the
+// exact pseudo inverse; singular values below epsilon are dropped.
+template <typename Derived, int Rows = Derived::RowsAtCompileTime, int Cols = Derived::ColsAtCompileTime>
+void dampedPseudoInverseSvd(const Eigen::MatrixBase<Derived> &J, double damping,
+                            Eigen::Matrix<double, Cols, Rows> &J_pinv, double epsilon = 1e-9)
+{
+  static_assert(Rows <= Cols, "the task must not have more rows than joints");
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, Rows, Cols> BoundedMatrix;
+  const Eigen::JacobiSVD<BoundedMatrix> svd(BoundedMatrix(J), Eigen::ComputeThinU | Eigen::ComputeThinV);
+  const auto &s = svd.singularValues();
+
+  Eigen::Matrix<double, Rows, 1> gain;
+  for (int i = 0; i < Rows; ++i)
+    gain(i) = s(i) > epsilon ? s(i) / (s(i) * s(i) + damping) : 0.0;
+
+  J_pinv.noalias() = svd.matrixV() * gain.asDiagonal() * svd.matrixU().transpose();
+}
+
+// Manipulability adaptive damping (Nakamura): no damping while
+// w = sqrt(det(J J^T)) stays above threshold, rising to max_damping as w
+// goes to zero. threshold must be positive. Returns the damping used.
+template <typename Derived, int Rows = Derived::RowsAtCompileTime, int Cols = Derived::ColsAtCompileTime>
+double adaptiveDampedPseudoInverse(const Eigen::MatrixBase<Derived> &J, double max_damping,
+                                   double threshold, Eigen::Matrix<double, Cols, Rows> &J_pinv)
+{
+  static_assert(Rows <= Cols, "the task must not have more rows than joints");
+  const Eigen::Matrix<double, Rows, Rows> JJt = J * J.transpose();
+
+  const Eigen::LDLT<Eigen::Matrix<double, Rows, Rows>> ldlt(JJt);
+  const double manipulability = std::sqrt(std::max(0.0, ldlt.vectorD().prod()));
+
+  double damping = 0.0;
+  if (manipulability < threshold)
+  {
+    const double ratio = manipulability / threshold;
+    damping = max_damping * (1.0 - ratio * ratio);
+  }
+
+  if (damping == 0.0 && ldlt.isPositive())
+  {
+    J_pinv = ldlt.solve(J).transpose();
+    return damping;
+  }
+  Eigen::Matrix<double, Rows, Rows> damped = JJt;
+  damped.diagonal().array() += damping;
+  J_pinv = damped.llt().solve(J).transpose();
+  return damping;
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/realtime_mailbox.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// Stabilizing solution X of the discrete algebraic Riccati equation
+//   X = A^T X A - A^T X B (R + B^T X B)^-1 B^T X A + Q
+// by the structure preserving doubling algorithm (Chu et al. 2004):
+//   W = I + G_k H_k
+//   A_k+1 = A_k W^-1 A_k
+//   G_k+1 = G_k + A_k W^-1 G_k A_k^T
+//   H_k+1 = H_k + A_k^T H_k W^-1 A_k
+// from A_0 = A, G_0 = B R^-1 B^T, H_0 = Q; H_k converges quadratically to X,
+// so a few tens of iterations reach machine precision. With fixed N and M
+// nothing is allocated. (A, B) must be stabilizable, (A, Q) detectable and R
+// positive definite. Returns false if it did not converge or diverged, X is
+// then not a solution.
+template <int N, int M>
+bool solveDiscreteRiccati(const Eigen::Matrix<double, N, N> &A, const Eigen::Matrix<double, N, M> &B,
+                          const Eigen::Matrix<double, N, N> &Q, const Eigen::Matrix<double, M, M> &R,
+                          Eigen::Matrix<double, N, N> &X, int max_iterations = 64, double tolerance = 1e-12)
+{
+  typedef Eigen::Matrix<double, N, N> MatrixN;
+  const int n = A.rows();
+
+  MatrixN A_k = A;
+  MatrixN G_k = B * R.llt().solve(B.transpose());
+  X = Q;
+  MatrixN W, W_inv_A, W_inv_G, W_inv_T_H, A_next;
+  Eigen::PartialPivLU<MatrixN> lu(n);
+
+  for (int i = 0; i < max_iterations; ++i)
+  {
+    W.noalias() = G_k * X;
+    W.diagonal().array() += 1.0;
+    lu.compute(W);
+    W_inv_A = lu.solve(A_k);
+    W_inv_G = lu.solve(G_k);
+
+    A_next.noalias() = A_k * W_inv_A;
+    G_k.noalias() += A_k * W_inv_G * A_k.transpose();
+    // H_k is symmetric, so H_k W^-1 = (W^-T H_k)^T
+    W_inv_T_H = lu.transpose().solve(X);
+    const MatrixN increment = A_k.transpose() * W_inv_T_H.transpose() * A_k;
+    X += increment;
+    A_k = A_next;
+
+    // an unstabilizable mode makes X blow up, and inf <= inf would pass the test below
+    if (!X.allFinite())
+      return false;
+    if (increment.cwiseAbs().maxCoeff() <= tolerance * (1.0 + X.cwiseAbs().maxCoeff()))
+    {
+      X = 0.5 * (X + X.transpose()).eval();
+      return true;
+    }
+  }
+  return false;
+}
+
+// u = -K x for the solution X of the same equation
+template <int N, int M>
+void discreteLqrGain(const Eigen::Matrix<double, N, N> &A, const Eigen::Matrix<double, N, M> &B,
+                     const Eigen::Matrix<double, M, M> &R, const Eigen::Matrix<double, N, N> &X,
+                     Eigen::Matrix<double, M, N> &K)
+{
+  const Eigen::Matrix<double, N, M> XB = X * B;
+  const Eigen::Matrix<double, M, M> S = R + B.transpose() * XB;
+  K = S.llt().solve(XB.transpose() * A);
+}
+
+// LQR gains of a linearization that changes with an operating point of P
+// coordinates (e.g. a joint configuration), for gain scheduling.
+//
+// update() only calls gain(): it takes the stored gain closest to the
+// current operating point, and when none lies within radius it hands the
+// point to the solver through a RealtimeMailbox and keeps the previous gain.
+// A non realtime thread calls solvePending() in a loop; it linearizes at the
+// requested point, solves the Riccati equation and hands the gain back the
+// same way. Neither side blocks or allocates. The table holds Capacity gains
+// and replaces the oldest one when full.
+//
+//   worker:   while (running_) { gains_.solvePending(linearize); sleep(); }
+//   update(): gains_.gain(q, K); tau = -K * (x - x_ref);
+//
+// linearize(point, A, B, Q, R) fills the model and weights at point.
+template <int N, int M, int P, int Capacity = 16>
+class LqrGainCache
+{
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  typedef Eigen::Matrix<double, P, 1> Point;
+  typedef Eigen::Matrix<double, M, N> Gain;
+
+  explicit LqrGainCache(double radius) : radius_squared_(radius * radius) {}
+
+  // seeds the table outside the control loop, e.g. in init()
+  template <class Linearize>
+  bool insert(const Point &point, Linearize linearize)
+  {
+    Entry entry;
+    if (!solve(point, linearize, entry))
+      return false;
+    store(entry);
+    return true;
+  }
+
+  // realtime side; false while no gain has been computed at all
+  bool gain(const Point &point, Gain &K)
+  {
+    if (results_.read())
+      store(results_.value());
+    if (size_ == 0)
+    {
+      request(point);
+      return false;
+    }
+
+    int nearest = 0;
+    double nearest_distance = (entries_[0].point - point).squaredNorm();
+    for (int i = 1; i < size_; ++i)
+    {
+      const double distance = (entries_[i].point - point).squaredNorm();
+      if (distance < nearest_distance)
+      {
+        nearest = i;
+        nearest_distance = distance;
+      }
+    }
+    if (nearest_distance > radius_squared_)
+      request(point);
+    K = entries_[nearest].gain;
+    return true;
+  }
+
+  // solver side; true if a gain was computed and handed over
+  template <class Linearize>
+  bool solvePending(Linearize linearize)
+  {
+    if (!requests_.read())
+      return false;
+    Entry entry;
+    if (!solve(requests_.value(), linearize, entry))
+      return false;
+    results_.write(entry);
+    return true;
+  }
+
+  int size() const { return size_; }
+
+ private:
+  struct Entry
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Point point;
+    Gain gain;
+  };
+
+  template <class Linearize>
+  static bool solve(const Point &point, Linearize &linearize, Entry &entry)
+  {
+    Eigen::Matrix<double, N, N> A, Q, X;
+    Eigen::Matrix<double, N, M> B;
+    Eigen::Matrix<double, M, M> R;
+    linearize(point, A, B, Q, R);
+    if (!solveDiscreteRiccati(A, B, Q, R, X))
+      return false;
+    entry.point = point;
+    discreteLqrGain(A, B, R, X, entry.gain);
+    return true;
+  }
+
+  void store(const Entry &entry)
+  {
+    entries_[next_] = entry;
+    next_ = (next_ + 1) % Capacity;
+    if (size_ < Capacity)
+      ++size_;
+  }
+
+  void request(const Point &point)
+  {
+    // give the solver time for the last one before asking again
+    if (ticks_since_request_ < kRequestInterval)
+    {
+      ++ticks_since_request_;
+      return;
+    }
+    ticks_since_request_ = 0;
+    requests_.write(point);
+  }
+
+  // ticks between two requests while the table misses
+  static constexpr int kRequestInterval = 100;
+
+  Entry entries_[Capacity];
+  int size_{0};
+  int next_{0};
+  double radius_squared_;
+
+  RealtimeMailbox<Point> requests_;
+  RealtimeMailbox<Entry> results_;
+  int ticks_since_request_{kRequestInterval};
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <controller_interface/multi_interface_controller.h>
+#include <franka_hw/franka_model_interface.h>
+#include <franka_hw/franka_state_interface.h>
+#include <hardware_interface/joint_command_interface.h>
+#include <hardware_interface/robot_hw.h>
+#include <ros/node_handle.h>
+#include <ros/ros.h>
+#include <ros/time.h>
+
+#include <advanced_robotics_franka_controllers/cycle_time_monitor.h>
+#include <advanced_robotics_franka_controllers/robot_state_recording.h>
+#include <advanced_robotics_franka_controllers/robot_state_snapshot.h>
+#include <advanced_robotics_franka_controllers/rt_logger.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// Handle plumbing shared by every panda controller in this package.
+// init() acquires the model, state and joint handles and then calls
+// initController(); update() refreshes snapshot_ once and then calls
+// updateController(). Every update is timed by cycle_time_, which is dumped
+// to the log in stopping(). Logging from update() goes through the RT_LOG_*
+// macros of rt_logger.h. Setting the record_file parameter captures the
+// per-tick input of the controller for tools/replay_node.
+template <class JointInterface>
+class FrankaControllerBase : public controller_interface::MultiInterfaceController<
+								   franka_hw::FrankaModelInterface,
+								   JointInterface,
+								   franka_hw::FrankaStateInterface> {
+ public:
+  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override final;
+  void update(const ros::Time& time, const ros::Duration& period) override final;
+  void stopping(const ros::Time& time) override final;
+
+ protected:
+  virtual bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) { return true; }
+  virtual void updateController(const ros::Time& time, const ros::Duration& period) = 0;
+  virtual void stoppingController(const ros::Time& time) {}
+
+  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
+  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
+  std::vector<hardware_interface::JointHandle> joint_handles_;
+
+  RobotStateSnapshot snapshot_;
+  CycleTimeMonitor cycle_time_;
+  RobotStateRecorder recorder_;
+};
+
+typedef FrankaControllerBase<hardware_interface::EffortJointInterface> TorqueControllerBase;
+typedef FrankaControllerBase<hardware_interface::PositionJointInterface> PositionControllerBase;
+typedef FrankaControllerBase<hardware_interface::VelocityJointInterface> VelocityControllerBase;
+
+
+template <class JointInterface>
+bool FrankaControllerBase<JointInterface>::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+{
+  std::vector<std::string> joint_names;
+  std::string arm_id;
+  if (!node_handle.getParam("arm_id", arm_id)) {
+    ROS_ERROR_STREAM(node_handle.getNamespace() << ": Could not read parameter arm_id");
+    return false;
+  }
+  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
+    ROS_ERROR_STREAM(node_handle.getNamespace()
+                     << ": Invalid or no joint_names parameters provided, aborting controller init!");
+    return false;
+  }
+
+  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
+  if (model_interface == nullptr) {
+    ROS_ERROR_STREAM(node_handle.getNamespace() << ": Error getting model interface from hardware");
+    return false;
+  }
+  try {
+    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
+        model_interface->getHandle(arm_id + "_model"));
+  } catch (hardware_interface::HardwareInterfaceException& ex) {
+    ROS_ERROR_STREAM(node_handle.getNamespace()
+                     << ": Exception getting model handle from interface: " << ex.what());
+    return false;
+  }
+
+  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
+  if (state_interface == nullptr) {
+    ROS_ERROR_STREAM(node_handle.getNamespace() << ": Error getting state interface from hardware");
+    return false;
+  }
+  try {
+    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
+        state_interface->getHandle(arm_id + "_robot"));
+  } catch (hardware_interface::HardwareInterfaceException& ex) {
+    ROS_ERROR_STREAM(node_handle.getNamespace()
+                     << ": Exception getting state handle from interface: " << ex.what());
+    return false;
+  }
+
+  auto* joint_interface = robot_hw->get<JointInterface>();
+  if (joint_interface == nullptr) {
+    ROS_ERROR_STREAM(node_handle.getNamespace() << ": Error getting joint interface from hardware");
+    return false;
+  }
+  joint_handles_.clear();
+  for (size_t i = 0; i < 7; ++i) {
+    try {
+      joint_handles_.push_back(joint_interface->getHandle(joint_names[i]));
+    } catch (const hardware_interface::HardwareInterfaceException& ex) {
+      ROS_ERROR_STREAM(node_handle.getNamespace() << ": Exception getting joint handles: " << ex.what());
+      return false;
+    }
+  }
+
+  snapshot_.update(state_handle_->getRobotState(), model_handle_.get());
+  cycle_time_.init(node_handle);
+  RtLogger::instance();
+
+  std::string record_file;
+  if (node_handle.getParam("record_file", record_file)) {
+    int record_capacity;
+    node_handle.param("record_capacity", record_capacity, 60000);
+    recorder_.open(record_file, record_capacity);
+  }
+
+  return initController(robot_hw, node_handle);
+}
+
+template <class JointInterface>
+void FrankaControllerBase<JointInterface>::update(const ros::Time& time, const ros::Duration& period)
+{
+  cycle_time_.begin(period);
+  snapshot_.update(state_handle_->getRobotState(), model_handle_.get());
+  if (recorder_.isOpen())
+    recorder_.append(time, period, snapshot_);
+  updateController(time, period);
+  cycle_time_.end();
+}
+
+template <class JointInterface>
+void FrankaControllerBase<JointInterface>::stopping(const ros::Time& time)
+{
+  stoppingController(time);
+  cycle_time_.dump();
+  cycle_time_.reset();
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <franka/robot_state.h>
+#include <franka_hw/franka_model_interface.h>
+#include <franka_hw/franka_state_interface.h>
+#include <franka_hw/model_base.h>
+#include <hardware_interface/joint_command_interface.h>
+#include <hardware_interface/joint_state_interface.h>
+#include <hardware_interface/robot_hw.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// RobotHW exposing the interfaces of franka_hw::FrankaHW on a local
+// franka::RobotState and command buffers. Backends without a robot connection
+// (simulation, replay, test harnesses) derive from it and call
+// registerInterfaces() with their franka_hw::ModelBase.
+class FrankaInterfaceHW : public hardware_interface::RobotHW
+{
+ public:
+  franka::RobotState &robotState() { return robot_state_; }
+  const franka::RobotState &robotState() const { return robot_state_; }
+
+  const std::array<double, 7> &effortCommand() const { return effort_command_; }
+  const std::array<double, 7> &positionCommand() const { return position_command_; }
+  const std::array<double, 7> &velocityCommand() const { return velocity_command_; }
+
+ protected:
+  void registerInterfaces(const std::string &arm_id, const std::vector<std::string> &joint_names,
+                          franka_hw::ModelBase &model);
+
+  franka::RobotState robot_state_;
+  std::array<double, 7> effort_command_{};
+  std::array<double, 7> position_command_{};
+  std::array<double, 7> velocity_command_{};
+
+ private:
+  hardware_interface::JointStateInterface joint_state_interface_;
+  hardware_interface::EffortJointInterface effort_joint_interface_;
+  hardware_interface::PositionJointInterface position_joint_interface_;
+  hardware_interface::VelocityJointInterface velocity_joint_interface_;
+  franka_hw::FrankaStateInterface franka_state_interface_;
+  franka_hw::FrankaModelInterface franka_model_interface_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+namespace advanced_robotics_franka_controllers {
+
+// Piecewise linear membership functions of Terms terms over one input, given
+// by their values at Breakpoints ascending breakpoints and constant outside
+// them (the usual trapezoid and shoulder shapes). The constructor turns the
+// table into a slope and an intercept per segment, so evaluate() counts the
+// breakpoints below the input and does one multiply-add per term, without a
+// division or an if/else ladder. The constructor is constexpr: tuned tables
+// are built at compile time, candidate tables of a parameter sweep at run time.
+//
+//   static constexpr double x[2] = {0.006, 0.007};
+//   static constexpr double mu[2][2] = {{1.0, 0.0}, {0.0, 1.0}};
+//   static constexpr MembershipTable<2, 2> velocity(x, mu);
+template <int Terms, int Breakpoints>
+class MembershipTable
+{
+  static_assert(Terms >= 1 && Breakpoints >= 1, "empty membership table");
+
+ public:
+  constexpr MembershipTable(const double (&x)[Breakpoints], const double (&membership)[Breakpoints][Terms])
+    : x_{}, slope_{}, intercept_{}
+  {
+    for (int i = 0; i < Breakpoints; ++i)
+      x_[i] = x[i];
+    for (int t = 0; t < Terms; ++t)
+    {
+      // segment s lies between x[s - 1] and x[s]
+      intercept_[0][t] = membership[0][t];
+      intercept_[Breakpoints][t] = membership[Breakpoints - 1][t];
+      for (int s = 1; s < Breakpoints; ++s)
+      {
+        const double width = x[s] - x[s - 1];
+        const double slope = width > 0.0 ? (membership[s][t] - membership[s - 1][t]) / width : 0.0;
+        slope_[s][t] = slope;
+        intercept_[s][t] = membership[s - 1][t] - slope * x[s - 1];
+      }
+    }
+  }
+
+  void evaluate(double value, double (&membership)[Terms]) const
+  {
+    int segment = 0;
+    for (int i = 0; i < Breakpoints; ++i)
+      segment += value > x_[i];
+    for (int t = 0; t < Terms; ++t)
+      membership[t] = intercept_[segment][t] + slope_[segment][t] * value;
+  }
+
+  constexpr double breakpoint(int i) const { return x_[i]; }
+
+ private:
+  double x_[Breakpoints];
+  double slope_[Breakpoints + 1][Terms];
+  double intercept_[Breakpoints + 1][Terms];
+};
+
+// Overlapping ramps over 2 Terms - 1 ascending breakpoints: term k is 1 at
+// x[2k], rises linearly from 0 at x[2k - 2] and falls linearly to 0 at
+// x[2k + 1]; the first and last terms stay 1 outside. Equal breakpoints
+// give a ramp of zero width. Every shape of fuzzycontrol.h is of this kind,
+// so a candidate set of breakpoints is all a tuning sweep has to vary.
+template <int Terms>
+constexpr MembershipTable<Terms, 2 * Terms - 1> rampMembershipTable(const double (&x)[2 * Terms - 1])
+{
+  double membership[2 * Terms - 1][Terms] = {};
+  for (int k = 0; k < Terms; ++k)
+  {
+    membership[2 * k][k] = 1.0;
+    if (k > 0)
+    {
+      const double width = x[2 * k] - x[2 * k - 2];
+      membership[2 * k - 1][k] = width > 0.0 ? (x[2 * k - 1] - x[2 * k - 2]) / width : 1.0;
+    }
+  }
+  return MembershipTable<Terms, 2 * Terms - 1>(x, membership);
+}
+
+constexpr int fuzzyRuleCount() { return 1; }
+template <class... Rest>
+constexpr int fuzzyRuleCount(int terms, Rest... rest)
+{
+  return terms * fuzzyRuleCount(rest...);
+}
+
+// Zero order Sugeno inference over one rule per combination of input terms:
+// a rule fires with the minimum of its memberships and the output is the
+// firing weighted mean of the rule consequents. The consequent table is
+// row major with the first input slowest, e.g. for <2, 5, 3> rule
+// 15 v + 3 z + f. Nothing is allocated; infer() is a fixed number of min
+// and multiply-add operations.
+template <int... Terms>
+class FuzzyRuleBase
+{
+ public:
+  static constexpr int kInputs = sizeof...(Terms);
+  static constexpr int kRules = fuzzyRuleCount(Terms...);
+
+  constexpr explicit FuzzyRuleBase(const double (&consequents)[kRules]) : consequents_{}
+  {
+    for (int r = 0; r < kRules; ++r)
+      consequents_[r] = consequents[r];
+  }
+
+  // memberships[i] points to the Terms[i] memberships of input i; returns
+  // 0 if no rule fires
+  double infer(const std::array<const double *, kInputs> &memberships) const
+  {
+    static constexpr int terms[kInputs] = {Terms...};
+    double strength[kRules];
+    strength[0] = 1.0;
+    int rules = 1;
+    for (int i = 0; i < kInputs; ++i)
+    {
+      // expand in place from the back, rule r becomes rules r * terms .. r * terms + terms - 1
+      for (int r = rules - 1; r >= 0; --r)
+      {
+        const double parent = strength[r];
+        for (int t = terms[i] - 1; t >= 0; --t)
+          strength[r * terms[i] + t] = std::min(parent, memberships[i][t]);
+      }
+      rules *= terms[i];
+    }
+
+    double num = 0.0;
+    double den = 0.0;
+    for (int r = 0; r < kRules; ++r)
+    {
+      num += strength[r] * consequents_[r];
+      den += strength[r];
+    }
+    return den > 0.0 ? num / den : 0.0;
+  }
+
+  constexpr double consequent(int r) const { return consequents_[r]; }
+
+ private:
+  double consequents_[kRules];
+};
+
+template <int... Terms>
+constexpr int FuzzyRuleBase<Terms...>::kInputs;
+template <int... Terms>
+constexpr int FuzzyRuleBase<Terms...>::kRules;
+
+}  // namespace advanced_robotics_franka_controllers
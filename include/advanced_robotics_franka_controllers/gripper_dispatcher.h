@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include <actionlib/client/simple_action_client.h>
+#include <franka_gripper/GraspAction.h>
+#include <franka_gripper/MoveAction.h>
+
+#include <advanced_robotics_franka_controllers/spsc_ring_buffer.h>
+
+namespace advanced_robotics_franka_controllers {
+
+struct GripperCommand
+{
+  enum Type : uint8_t
+  {
+    kNone,
+    kGrasp,
+    kMove
+  };
+
+  Type type{kNone};
+  double width{0.0};
+  double speed{0.0};
+  double force{0.0};
+  double epsilon_inner{0.0};
+  double epsilon_outer{0.0};
+  // sequence number, not part of the comparison
+  uint64_t id{0};
+
+  bool operator==(const GripperCommand &other) const
+  {
+    return type == other.type && width == other.width && speed == other.speed && force == other.force &&
+           epsilon_inner == other.epsilon_inner && epsilon_outer == other.epsilon_outer;
+  }
+  bool operator!=(const GripperCommand &other) const { return !(*this == other); }
+};
+
+// Sends franka_gripper grasp/move goals on behalf of update().
+// grasp() and move() are real-time safe: a command equal to the previous one
+// is dropped, so only a change of command reaches the driver, and a worker
+// thread sends it to /franka_gripper once the action server is up. The same
+// command is sent again only if the previous one failed, or after reset().
+// state() reports the result of the last command without locking, so
+// update() can wait for it instead of posting on every tick. Call reset()
+// from starting() so a restarted controller sends its first command even if
+// it equals the last one.
+class GripperDispatcher
+{
+ public:
+  enum class State : uint8_t
+  {
+    kIdle,
+    kPending,    // queued or sent, no result yet
+    kSucceeded,
+    kFailed
+  };
+
+  GripperDispatcher();
+  ~GripperDispatcher();
+
+  void grasp(double width, double speed, double force, double epsilon_inner, double epsilon_outer);
+  void move(double width, double speed);
+  // update() side; forgets the previous command
+  void reset();
+
+  // update() side; state of the last posted command, kIdle after reset()
+  State state() const;
+  // id of the last posted command and of the last command with a result
+  uint64_t postedId() const { return last_posted_.id; }
+  uint64_t finishedId() const { return result_.load(std::memory_order_acquire) >> 1; }
+
+ private:
+  void post(const GripperCommand &command);
+  void workerLoop();
+  void send(const GripperCommand &command);
+  void done(const GripperCommand &command, const actionlib::SimpleClientGoalState &goal_state);
+
+  // update() side
+  GripperCommand last_posted_;
+
+  SpscRingBuffer<GripperCommand> mailbox_;
+  // id of the newest posted command; results of older ones are ignored
+  std::atomic<uint64_t> latest_id_{0};
+  // id of the newest command with a result, shifted left, and 1 if it failed
+  std::atomic<uint64_t> result_{0};
+
+  std::unique_ptr<actionlib::SimpleActionClient<franka_gripper::GraspAction>> grasp_client_;
+  std::unique_ptr<actionlib::SimpleActionClient<franka_gripper::MoveAction>> move_client_;
+
+  std::thread worker_;
+  std::atomic<bool> running_{false};
+};
+
+}  // namespace advanced_robotics_franka_controllers
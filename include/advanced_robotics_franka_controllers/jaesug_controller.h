@@ -5,7 +5,8 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -21,14 +22,14 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class JaesugController : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class JaesugController : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
   Eigen::Matrix<double, 6, 1> getfstar();
   Eigen::Matrix<double, 6, 1> getfstar2();
   Eigen::Matrix<double, 6, 1> getfstar3();
@@ -39,15 +40,13 @@ class JaesugController : public controller_interface::MultiInterfaceController<
   void dyn_consist_ik(Eigen::Matrix<double, 6, 7> Jtask);
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
   ros::Time start_time_;
 
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
   Eigen::Matrix<double, 7, 1> dq_filtered_;
   Eigen::Matrix<double, 6, 1> control_state;
@@ -59,8 +58,13 @@ class JaesugController : public controller_interface::MultiInterfaceController<
   Eigen::Matrix<double , 7, 1> q_desired;
   Eigen::Matrix<double , 7, 1> qd_desired;
   Eigen::Matrix<double , 7, 1> gstar;
-  RobotModel * robot_;
-  RobotModel * robot_test;
+  // task space phase, set up when it starts
+  CubicSegment ee_path_[3];
+  CubicSegment angle_path_[3];
+  CubicSegment wrist_path_[3];
+  CubicSegment axis_angle_path_;
+  RobotModel<7> * robot_;
+  RobotModel<7> * robot_test;
   Eigen::Vector3d pos_ee;
   Eigen::Vector3d pos_virtual1;
   Eigen::Vector3d pos_virtual2;
@@ -101,10 +105,10 @@ class JaesugController : public controller_interface::MultiInterfaceController<
   Eigen::Vector3d tipVector1;
   Eigen::Vector3d tipVector2;
   Eigen::MatrixXd J_task;
-  Eigen::MatrixXd Jacob_ee;
-  Eigen::MatrixXd Jacob_wrist;
-  Eigen::MatrixXd Jacob_ee2;
-  Eigen::MatrixXd Jacob_ee3;
+  Eigen::Matrix<double, 6, 7> Jacob_ee;
+  Eigen::Matrix<double, 6, 7> Jacob_wrist;
+  Eigen::Matrix<double, 6, 7> Jacob_ee2;
+  Eigen::Matrix<double, 6, 7> Jacob_ee3;
   Eigen::Matrix3d Rot_cur;
   Eigen::Matrix3d Rot_wrist;
   Eigen::Matrix3d Rot_init;
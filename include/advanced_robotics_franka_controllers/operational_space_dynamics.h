@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace advanced_robotics_franka_controllers {
+
+// End effector operational space dynamics of the panda, computed from one
+// Cholesky factorization of the joint space mass matrix M:
+//   lambda    = (J M^-1 J^T)^-1
+//   J_bar     = M^-1 J^T lambda          (dynamically consistent inverse)
+//   N         = I - J^T J_bar^T          (torque null space projector)
+//   wrench(t) = J_bar^T t                (e.g. t = tau_measured - gravity)
+// Fixed size throughout, so it is cheap to construct in update().
+class OperationalSpaceDynamics
+{
+ public:
+  typedef Eigen::Matrix<double, 7, 7> Matrix7d;
+  typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+  typedef Eigen::Matrix<double, 6, 7> Matrix67d;
+  typedef Eigen::Matrix<double, 7, 6> Matrix76d;
+  typedef Eigen::Matrix<double, 7, 1> Vector7d;
+  typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+  OperationalSpaceDynamics() = default;
+  OperationalSpaceDynamics(const Matrix7d &mass, const Matrix67d &jacobian) { update(mass, jacobian); }
+
+  void update(const Matrix7d &mass, const Matrix67d &jacobian);
+
+  const Matrix6d &lambda() const { return lambda_; }
+  const Matrix76d &jacobianBar() const { return jacobian_bar_; }
+  const Matrix7d &nullSpaceProjector() const { return null_space_projector_; }
+
+  Vector6d wrench(const Vector7d &tau) const { return jacobian_bar_.transpose() * tau; }
+
+ private:
+  Matrix6d lambda_;
+  Matrix76d jacobian_bar_;
+  Matrix7d null_space_projector_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
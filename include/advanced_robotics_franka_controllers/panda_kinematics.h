@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace advanced_robotics_franka_controllers {
+
+// Closed form panda kinematics on the (Craig) DH parameters of the franka
+// documentation. The link twists are all 0 or +-pi/2, so every link step is a
+// column swap plus one planar rotation; each joint's sin/cos is taken once
+// and shared by the pose and the jacobian. No tree walk, no allocation.
+// A fast path next to the RBDL RobotModel, whose body 7 frame is
+// flange * diag(1, -1, -1) translated back by d_flange.
+//
+//   PandaKinematics kinematics(q);
+//   Eigen::Affine3d O_T_F = kinematics.flange();
+//   kinematics.jacobian(F_T_EE.translation(), J);   // [linear; angular]
+class PandaKinematics
+{
+ public:
+  typedef Eigen::Matrix<double, 7, 1> Vector7d;
+  typedef Eigen::Matrix<double, 6, 7> Matrix67d;
+
+  // a_{i-1}, d_i and alpha_{i-1} of joints 1..7 and the flange
+  static constexpr double kA[8] = {0.0, 0.0, 0.0, 0.0825, -0.0825, 0.0, 0.088, 0.0};
+  static constexpr double kD[8] = {0.333, 0.0, 0.316, 0.0, 0.384, 0.0, 0.0, 0.107};
+  // alpha_{i-1} / (pi/2)
+  static constexpr int kTwist[8] = {0, -1, 1, 1, -1, 1, 1, 0};
+
+  PandaKinematics() = default;
+  explicit PandaKinematics(const Vector7d &q) { update(q); }
+
+  void update(const Vector7d &q);
+
+  // base to flange
+  Eigen::Affine3d flange() const;
+  // geometric jacobian of the point tip (flange frame), in the base frame
+  void jacobian(const Eigen::Vector3d &tip, Matrix67d &J) const;
+  void jacobian(Matrix67d &J) const { jacobian(Eigen::Vector3d::Zero(), J); }
+
+  const Eigen::Matrix3d &flangeRotation() const { return flange_rotation_; }
+  const Eigen::Vector3d &flangePosition() const { return flange_position_; }
+
+ private:
+  // origin and z axis of the joint i frame
+  Eigen::Vector3d origin_[7];
+  Eigen::Vector3d axis_[7];
+  Eigen::Matrix3d flange_rotation_;
+  Eigen::Vector3d flange_position_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
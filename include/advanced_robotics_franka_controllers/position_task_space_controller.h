@@ -5,7 +5,8 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -21,19 +22,13 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class PositionTaskSpaceController : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-                 	 hardware_interface::PositionJointInterface,  
-								   franka_hw::FrankaStateInterface> {
+class PositionTaskSpaceController : public PositionControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
   ros::Time start_time_;
 
@@ -47,6 +42,8 @@ class PositionTaskSpaceController : public controller_interface::MultiInterfaceC
 
   ros::Time time_;
   ros::Duration elapsed_time_;
+  // end effector position over elapsed_time_, set up in starting()
+  CubicSegment path_[3];
 
   Eigen::Matrix<double , 7, 1> q_desired_last;
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace advanced_robotics_franka_controllers {
+
+// Latest-value handoff from a subscriber callback to update().
+// A triple buffer: write() fills a private slot and publishes it with one
+// atomic exchange, read() takes the newest published slot the same way.
+// Neither side waits or allocates, and update() always sees a whole message,
+// never one that is half written. Intermediate values written between two
+// reads are skipped. One writer thread and one reader thread.
+//
+//   void callback(const Msg &msg) { mailbox_.write(convert(msg)); }
+//   update(): if (mailbox_.read()) local_ = mailbox_.value();
+template <class T>
+class RealtimeMailbox
+{
+ public:
+  RealtimeMailbox() = default;
+  explicit RealtimeMailbox(const T &initial) : slots_{initial, initial, initial} {}
+
+  // writer side
+  void write(const T &value)
+  {
+    slots_[back_] = value;
+    back_ = state_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+  }
+
+  // reader side; true if a value newer than the last read arrived
+  bool read()
+  {
+    if ((state_.load(std::memory_order_relaxed) & kFresh) == 0)
+      return false;
+    front_ = state_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    return true;
+  }
+
+  // reader side; the value taken by the last successful read()
+  const T &value() const { return slots_[front_]; }
+
+ private:
+  static constexpr uint8_t kIndex = 0x3;
+  static constexpr uint8_t kFresh = 0x4;
+
+  T slots_[3]{};
+  uint8_t back_{0};
+  uint8_t front_{1};
+  std::atomic<uint8_t> state_{2};
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <realtime_tools/realtime_publisher.h>
+#include <ros/node_handle.h>
+#include <ros/time.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// Decimated topic output for update().
+// tryAcquire() returns the message to fill when a publish is due at the
+// configured rate and the publisher thread has finished the previous message,
+// otherwise nullptr; it never waits for the ROS transport. The rate follows
+// the time passed to update(), so a replay or simulation decimates like the
+// robot. A filled message is handed to the publisher thread with publish().
+// Skipped ticks are counted.
+//
+//   if (auto *msg = stream_.tryAcquire(time)) {
+//     msg->x = ...;
+//     stream_.publish();
+//   }
+template <class Msg>
+class RealtimeStream
+{
+ public:
+  // rate in Hz; 0 publishes on every tick
+  void init(ros::NodeHandle &node_handle, const std::string &topic, double rate, size_t queue_size = 1)
+  {
+    every_tick_ = rate <= 0.0;
+    if (!every_tick_)
+      period_ = ros::Duration(1.0 / rate);
+    next_ = ros::Time(0);
+    publisher_.init(node_handle, topic, queue_size);
+    skipped_ = 0;
+  }
+
+  Msg *tryAcquire(const ros::Time &time)
+  {
+    if (!every_tick_)
+    {
+      // the clock restarted, e.g. a new replay
+      if (next_ - time > period_)
+        next_ = time;
+      if (time < next_)
+        return nullptr;
+      // keep the phase, but do not catch up on a gap with a burst
+      next_ += period_;
+      if (next_ <= time)
+        next_ = time + period_;
+    }
+    if (!publisher_.trylock())
+    {
+      ++skipped_;
+      return nullptr;
+    }
+    return &publisher_.msg_;
+  }
+
+  // Only after a successful tryAcquire().
+  void publish() { publisher_.unlockAndPublish(); }
+
+  uint64_t skipped() const { return skipped_; }
+
+ private:
+  bool every_tick_{true};
+  ros::Duration period_;
+  ros::Time next_;
+  realtime_tools::RealtimePublisher<Msg> publisher_;
+  uint64_t skipped_{0};
+};
+
+}  // namespace advanced_robotics_franka_controllers
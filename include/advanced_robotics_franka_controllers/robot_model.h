@@ -4,6 +4,7 @@
 #include <rbdl/rbdl.h>
 #include <rbdl/rbdl_config.h>
 
+#include <array>
 #include <iostream>
 #include <memory>
 #include <fstream>
@@ -11,25 +12,61 @@
 using namespace RigidBodyDynamics;
 using namespace Eigen;
 using namespace std;
-#define dof 7
 typedef Transform<double, 3, Eigen::Affine> Transform3d;
 
 
+// RBDL model of the panda arm with the number of joints fixed at compile time.
+// All outputs and RBDL work buffers are sized in the constructor, so the
+// getters below do not allocate and can be called from update().
+// Kinematics are evaluated at the configuration of the last
+// getUpdateKinematics(); jacobians are [linear; angular].
+// Only RobotModel<7> is instantiated (see robot_model.cpp).
+template <int DOF>
 class RobotModel
 {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    typedef Matrix<double, DOF, 1> VectorQd;
+    typedef Matrix<double, DOF, DOF> MatrixQd;
+    typedef Matrix<double, 6, DOF> Matrix6Qd;
+
+    // a point fixed in the body frame of joint frame_id
+    struct KinematicsQuery
+    {
+        int frame_id;
+        Vector3d tip_pos;
+    };
+    struct KinematicsResult
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        Vector3d position;
+        Matrix3d orientation;
+        Matrix6Qd jacobian;
+    };
+
     RobotModel();
     ~RobotModel();
 
-    void getUpdateKinematics(const VectorXd &q, const VectorXd &qdot);
+    void getUpdateKinematics(const VectorQd &q, const VectorQd &qdot);
 
-    const MatrixXd &getJacobian(const int &frame_id, Vector3d& tip_pos)
+    // writes the jacobian into J without a temporary
+    void getJacobian(const int &frame_id, const Vector3d& tip_pos, Ref<Matrix6Qd> J);
+    const Matrix6Qd &getJacobian(const int &frame_id, const Vector3d& tip_pos)
     {
-        Jacobian(frame_id, tip_pos);
+        getJacobian(frame_id, tip_pos, m_J_);
         return m_J_;
     }
-    const Vector3d &getPosition(const int &frame_id, Vector3d& tip_pos)
+    // Position, orientation and jacobian of count points in one pass.
+    // RBDL is queried once per distinct body; further points on the same body
+    // are derived from the first by the rigid body offset.
+    void getKinematics(const KinematicsQuery *queries, KinematicsResult *results, int count);
+    template <size_t N>
+    void getKinematics(const std::array<KinematicsQuery, N> &queries, std::array<KinematicsResult, N> &results)
+    {
+        getKinematics(queries.data(), results.data(), static_cast<int>(N));
+    }
+
+    const Vector3d &getPosition(const int &frame_id, const Vector3d& tip_pos)
     {
         Position(frame_id, tip_pos);
         return m_pos_;
@@ -39,61 +76,88 @@ public:
         Orientation(frame_id);
         return m_Ori_;
     }
-    const Transform3d &getTransformation(const int &frame_id, Vector3d& tip_pos)
+    const Transform3d &getTransformation(const int &frame_id, const Vector3d& tip_pos)
     {
         Transformation(frame_id, tip_pos);
         return m_Trans_;
     }
+    // dynamics at the configuration of the last getUpdateKinematics():
+    // mass matrix by CRBA, gravity, coriolis and nonlinear effects by RNEA
+    const MatrixQd &getMassMatrix()
+    {
+        MassMatrix();
+        return m_M_;
+    }
+    const VectorQd &getGravity()
+    {
+        GravityTorque();
+        return m_g_;
+    }
+    const VectorQd &getCoriolis()
+    {
+        CoriolisTorque();
+        return m_c_;
+    }
+    const VectorQd &getNonlinearEffects()
+    {
+        NonlinearTorque();
+        return m_nle_;
+    }
+    const VectorQd &getForwardDynamics(const VectorQd &tau)
+    {
+        Acceleration(tau);
+        return m_qddot_;
+    }
 
 private:
-    void Jacobian(const int &frame_id, Vector3d& tip_pos);
-    void Position(const int &frame_id, Vector3d& tip_pos);
+    void Position(const int &frame_id, const Vector3d& tip_pos);
     void Orientation(const int &frame_id);
-    void Transformation(const int &frame_id, Vector3d& tip_pos);
+    void Transformation(const int &frame_id, const Vector3d& tip_pos);
+    void MassMatrix();
+    void GravityTorque();
+    void NonlinearTorque();
+    void CoriolisTorque();
+    void Acceleration(const VectorQd &tau);
 	void setRobot();
 
     /////////////////////////////////////////////////////////////////
     shared_ptr<Model> model_;
-    Body body_[dof];
+    Body body_[DOF];
     Body base_;
 
-    Joint joint_[dof];
-
-    VectorXd q_;
-    VectorXd qdot_;
-
-    VectorXd q_real_;
-    VectorXd qdot_real_;
-
-    double mass_[dof];
-    Math::Vector3d axis_[dof];
-    Math::Vector3d inertia_[dof];
-    Math::Vector3d joint_position_global_[dof];
-    Math::Vector3d joint_position_local_[dof];
-    Math::Vector3d com_position_[dof];
+    Joint joint_[DOF];
 
+    double mass_[DOF];
+    Math::Vector3d axis_[DOF];
+    Math::Matrix3d inertia_[DOF];
+    Math::Matrix3d dh_rotation_[DOF];
+    Math::Vector3d joint_position_global_[DOF];
+    Math::Vector3d joint_position_local_[DOF];
+    Math::Vector3d com_position_[DOF];
 
+    // RBDL takes dynamic size arguments; these are sized once to DOF
     Math::VectorNd q_rbdl_;
     Math::VectorNd qdot_rbdl_;
     Math::VectorNd qddot_rbdl_;
-    Math::VectorNd tau_;
+    Math::VectorNd zero_rbdl_;
+    Math::VectorNd tau_rbdl_;
+    Math::VectorNd result_rbdl_;
+    Math::MatrixNd J_rbdl_;
+    Math::MatrixNd M_rbdl_;
 
-    unsigned int body_id_[dof];
+    unsigned int body_id_[DOF];
 
     Vector3d m_pos_;
     Matrix3d m_Ori_;
-    MatrixXd m_J_;
+    Matrix6Qd m_J_;
+    MatrixQd m_M_;
+    VectorQd m_g_;
+    VectorQd m_c_;
+    VectorQd m_nle_;
+    VectorQd m_qddot_;
 
     Transform3d m_Trans_;
     Transform3d m_base_;
-
-    int m_robot_type_;
-
-
-protected:
-    unsigned int m_nv_;
-    unsigned int m_na_;
-    unsigned int m_nq_;
 };
 
-#endif
\ No newline at end of file
+#endif
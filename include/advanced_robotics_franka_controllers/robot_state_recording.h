@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include <franka/robot_state.h>
+#include <ros/time.h>
+
+#include <advanced_robotics_franka_controllers/robot_state_snapshot.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// franka::RobotState is not trivially copyable (franka::Errors holds references),
+// so recordings store this plain copy of the fields the controllers read.
+#define ROBOT_STATE_RECORD_FIELDS(X)                                                          \
+  X(O_T_EE) X(O_T_EE_d) X(F_T_EE) X(EE_T_K) X(m_ee) X(I_ee) X(F_x_Cee) X(m_load) X(I_load)   \
+  X(F_x_Cload) X(m_total) X(I_total) X(F_x_Ctotal) X(elbow) X(elbow_d) X(tau_J) X(tau_J_d)    \
+  X(dtau_J) X(q) X(q_d) X(dq) X(dq_d) X(ddq_d) X(joint_contact) X(cartesian_contact)          \
+  X(joint_collision) X(cartesian_collision) X(tau_ext_hat_filtered) X(O_F_ext_hat_K)         \
+  X(K_F_ext_hat_K) X(O_dP_EE_d) X(theta) X(dtheta) X(control_command_success_rate)
+
+struct RecordedRobotState
+{
+#define ROBOT_STATE_RECORD_MEMBER(field) decltype(franka::RobotState::field) field;
+  ROBOT_STATE_RECORD_FIELDS(ROBOT_STATE_RECORD_MEMBER)
+#undef ROBOT_STATE_RECORD_MEMBER
+  uint64_t time_ms;
+};
+
+// Everything a controller reads in one update()
+struct RecordedTick
+{
+  int64_t time_ns;
+  int64_t period_ns;
+  RecordedRobotState state;
+  std::array<double, 42> jacobian;
+  std::array<double, 49> mass;
+  std::array<double, 7> coriolis;
+  std::array<double, 7> gravity;
+};
+static_assert(std::is_trivially_copyable<RecordedTick>::value, "RecordedTick is written with memcpy");
+
+void toRecordedState(const franka::RobotState &robot_state, RecordedRobotState &recorded);
+void fromRecordedState(const RecordedRobotState &recorded, franka::RobotState &robot_state);
+
+// Appends ticks to a memory mapped file. The file is sized and its pages
+// populated in open(), so append() is a bounded memcpy that is safe to call
+// from update(). Ticks beyond the capacity are counted and dropped.
+class RobotStateRecorder
+{
+ public:
+  ~RobotStateRecorder();
+
+  bool open(const std::string &file_name, size_t capacity);
+  void close();
+  bool isOpen() const { return ticks_ != nullptr; }
+
+  bool append(const ros::Time &time, const ros::Duration &period, const RobotStateSnapshot &snapshot);
+
+  size_t size() const;
+  size_t dropped() const { return dropped_; }
+
+ private:
+  int fd_{-1};
+  void *map_{nullptr};
+  size_t map_size_{0};
+  RecordedTick *ticks_{nullptr};
+  size_t capacity_{0};
+  size_t dropped_{0};
+};
+
+// Read-only view of a recording made by RobotStateRecorder.
+class RobotStateRecording
+{
+ public:
+  ~RobotStateRecording();
+
+  bool open(const std::string &file_name);
+  void close();
+
+  size_t size() const { return size_; }
+  const RecordedTick &operator[](size_t i) const { return ticks_[i]; }
+
+ private:
+  void *map_{nullptr};
+  size_t map_size_{0};
+  const RecordedTick *ticks_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <franka/robot_state.h>
+#include <franka_hw/franka_model_interface.h>
+
+namespace advanced_robotics_franka_controllers {
+
+// Per-tick view of the robot state plus the libfranka model quantities.
+// The state is referenced, not copied. Each model quantity is evaluated on its
+// first read within a tick and cached until the next update(), so a controller
+// only pays for the model calls it actually uses.
+class RobotStateSnapshot
+{
+ public:
+  void update(const franka::RobotState &robot_state, franka_hw::FrankaModelHandle *model_handle)
+  {
+    robot_state_ = &robot_state;
+    model_handle_ = model_handle;
+    valid_ = 0;
+  }
+
+  const franka::RobotState &robotState() const { return *robot_state_; }
+
+  // Zero jacobian of the end effector, column-major 6x7
+  const std::array<double, 42> &jacobian() const
+  {
+    if (!(valid_ & kJacobian))
+    {
+      jacobian_ = model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
+      valid_ |= kJacobian;
+    }
+    return jacobian_;
+  }
+
+  // Joint space mass matrix, column-major 7x7
+  const std::array<double, 49> &mass() const
+  {
+    if (!(valid_ & kMass))
+    {
+      mass_ = model_handle_->getMass();
+      valid_ |= kMass;
+    }
+    return mass_;
+  }
+
+  const std::array<double, 7> &coriolis() const
+  {
+    if (!(valid_ & kCoriolis))
+    {
+      coriolis_ = model_handle_->getCoriolis();
+      valid_ |= kCoriolis;
+    }
+    return coriolis_;
+  }
+
+  const std::array<double, 7> &gravity() const
+  {
+    if (!(valid_ & kGravity))
+    {
+      gravity_ = model_handle_->getGravity();
+      valid_ |= kGravity;
+    }
+    return gravity_;
+  }
+
+ private:
+  enum : uint8_t
+  {
+    kJacobian = 1 << 0,
+    kMass = 1 << 1,
+    kCoriolis = 1 << 2,
+    kGravity = 1 << 3
+  };
+
+  const franka::RobotState *robot_state_{nullptr};
+  franka_hw::FrankaModelHandle *model_handle_{nullptr};
+
+  mutable uint8_t valid_{0};
+  mutable std::array<double, 42> jacobian_;
+  mutable std::array<double, 49> mass_;
+  mutable std::array<double, 7> coriolis_;
+  mutable std::array<double, 7> gravity_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
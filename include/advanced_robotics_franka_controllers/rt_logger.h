@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/spsc_ring_buffer.h>
+
+namespace advanced_robotics_franka_controllers {
+
+enum class RtLogLevel : uint8_t
+{
+  kInfo,
+  kWarn,
+  kError
+};
+
+// One log call: the format string and its arguments, captured by value.
+struct RtLogMessage
+{
+  static constexpr size_t kMaxArgs = 8;
+  static constexpr size_t kMaxValues = 32;
+
+  enum ArgType : uint8_t
+  {
+    kInteger,
+    kReal,
+    kString,
+    kMatrix
+  };
+
+  struct Arg
+  {
+    ArgType type;
+    uint8_t rows;
+    uint8_t cols;
+    uint8_t offset;
+  };
+
+  union Value
+  {
+    int64_t integer;
+    double real;
+    const char *string;
+  };
+
+  RtLogLevel level;
+  uint8_t arg_count;
+  uint8_t value_count;
+  const char *format;
+  Arg args[kMaxArgs];
+  Value values[kMaxValues];
+};
+
+// Console logging for the real-time loop.
+// log() copies the arguments into a fixed-size message and pushes it to a
+// preallocated queue; a background thread formats the messages and hands them
+// to rosconsole. Each "{}" in the format is replaced by the next argument.
+// Arguments may be integers, floating point values, string literals and
+// evaluated Eigen matrices (row-major, at most kMaxValues coefficients per
+// message). Strings are stored by pointer, so they must outlive the call.
+//
+// Use the RT_LOG_* macros below. The _THROTTLE variants limit each call site
+// to one message per period.
+class RtLogger
+{
+ public:
+  static constexpr size_t kCapacity = 1024;
+
+  // The first call starts the output thread. FrankaControllerBase::init()
+  // makes that call so that update() never does.
+  static RtLogger &instance();
+
+  ~RtLogger();
+
+  // Real-time safe. Drops the message when the queue is full.
+  template <typename... Args>
+  void log(RtLogLevel level, const char *format, const Args &... args)
+  {
+    RtLogMessage message;
+    message.level = level;
+    message.format = format;
+    message.arg_count = 0;
+    message.value_count = 0;
+    const int expand[] = {0, (capture(message, args), 0)...};
+    (void)expand;
+    push(message);
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  RtLogger();
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value>::type capture(RtLogMessage &message, T value)
+  {
+    RtLogMessage::Arg *arg = addArg(message, RtLogMessage::kInteger, 1, 1);
+    if (arg != nullptr)
+      message.values[arg->offset].integer = static_cast<int64_t>(value);
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type capture(RtLogMessage &message, T value)
+  {
+    RtLogMessage::Arg *arg = addArg(message, RtLogMessage::kReal, 1, 1);
+    if (arg != nullptr)
+      message.values[arg->offset].real = static_cast<double>(value);
+  }
+
+  static void capture(RtLogMessage &message, const char *value)
+  {
+    RtLogMessage::Arg *arg = addArg(message, RtLogMessage::kString, 1, 1);
+    if (arg != nullptr)
+      message.values[arg->offset].string = value;
+  }
+
+  template <typename Derived>
+  static void capture(RtLogMessage &message, const Eigen::DenseBase<Derived> &value)
+  {
+    RtLogMessage::Arg *arg = addArg(message, RtLogMessage::kMatrix, value.rows(), value.cols());
+    if (arg == nullptr)
+      return;
+    RtLogMessage::Value *out = message.values + arg->offset;
+    for (Eigen::Index r = 0; r < value.rows(); ++r)
+      for (Eigen::Index c = 0; c < value.cols(); ++c)
+        (out++)->real = static_cast<double>(value.derived().coeff(r, c));
+  }
+
+  // Returns nullptr when the message has no room left for the argument.
+  static RtLogMessage::Arg *addArg(RtLogMessage &message, RtLogMessage::ArgType type, Eigen::Index rows,
+                                   Eigen::Index cols);
+
+  void push(const RtLogMessage &message);
+  void outputLoop();
+
+  SpscRingBuffer<RtLogMessage> queue_;
+  // held while pushing; a second producer drops its message instead of waiting
+  std::atomic_flag producer_busy_ = ATOMIC_FLAG_INIT;
+
+  std::thread output_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+// Rate limit of one log call site.
+class RtLogSite
+{
+ public:
+  // True at most once per period seconds.
+  bool ready(double period);
+
+ private:
+  std::atomic<int64_t> last_ns_{INT64_MIN};
+};
+
+}  // namespace advanced_robotics_franka_controllers
+
+#define RT_LOG(level, ...) \
+  ::advanced_robotics_franka_controllers::RtLogger::instance().log(level, __VA_ARGS__)
+
+#define RT_LOG_THROTTLE(level, period, ...)                                     \
+  do                                                                            \
+  {                                                                             \
+    static ::advanced_robotics_franka_controllers::RtLogSite rt_log_site;       \
+    if (rt_log_site.ready(period))                                              \
+      RT_LOG(level, __VA_ARGS__);                                               \
+  } while (0)
+
+#define RT_LOG_INFO(...) RT_LOG(::advanced_robotics_franka_controllers::RtLogLevel::kInfo, __VA_ARGS__)
+#define RT_LOG_WARN(...) RT_LOG(::advanced_robotics_franka_controllers::RtLogLevel::kWarn, __VA_ARGS__)
+#define RT_LOG_ERROR(...) RT_LOG(::advanced_robotics_franka_controllers::RtLogLevel::kError, __VA_ARGS__)
+
+#define RT_LOG_INFO_THROTTLE(period, ...) \
+  RT_LOG_THROTTLE(::advanced_robotics_franka_controllers::RtLogLevel::kInfo, period, __VA_ARGS__)
+#define RT_LOG_WARN_THROTTLE(period, ...) \
+  RT_LOG_THROTTLE(::advanced_robotics_franka_controllers::RtLogLevel::kWarn, period, __VA_ARGS__)
+#define RT_LOG_ERROR_THROTTLE(period, ...) \
+  RT_LOG_THROTTLE(::advanced_robotics_franka_controllers::RtLogLevel::kError, period, __VA_ARGS__)
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+namespace advanced_robotics_franka_controllers {
+
+// Statistics of the last Capacity samples of a signal (e.g. a force), in a
+// fixed ring buffer: push() and every query are O(1) and nothing is
+// allocated, however long the signal runs.
+//
+// The sums are updated by adding the new and subtracting the evicted
+// sample, and recomputed from the window once every Capacity evictions so
+// rounding does not accumulate. They are taken about a recent sample, so
+// the variance of a small ripple on a large offset stays accurate.
+// min() and max() come from monotonic index queues (amortized O(1)).
+//
+//   update(): fx_ee_.push(force_ee(0));
+//             if (std::fabs(fx_ee_.difference()) >= 8.0) ...
+template <int Capacity>
+class RunningStatistics
+{
+  static_assert(Capacity >= 2, "the window needs at least two samples");
+
+ public:
+  RunningStatistics() { clear(); }
+
+  void clear()
+  {
+    size_ = 0;
+    head_ = 0;
+    offset_ = sum_ = abs_sum_ = square_sum_ = 0.0;
+    evictions_ = 0;
+    min_queue_.clear();
+    max_queue_.clear();
+    count_ = 0;
+  }
+
+  void push(double value)
+  {
+    if (size_ == 0 && evictions_ == 0)
+      offset_ = value;
+    if (size_ == Capacity)
+    {
+      const double old = values_[head_];
+      const double old_shifted = old - offset_;
+      sum_ -= old_shifted;
+      abs_sum_ -= std::fabs(old);
+      square_sum_ -= old_shifted * old_shifted;
+      --size_;
+      head_ = (head_ + 1) % Capacity;
+      ++evictions_;
+    }
+    values_[(head_ + size_) % Capacity] = value;
+    ++size_;
+    const double shifted = value - offset_;
+    sum_ += shifted;
+    abs_sum_ += std::fabs(value);
+    square_sum_ += shifted * shifted;
+
+    // index count_ is the new sample; anything before count_ - size_ + 1 left the window
+    const long oldest = count_ - size_ + 1;
+    min_queue_.dropBefore(oldest);
+    max_queue_.dropBefore(oldest);
+    min_queue_.push(count_, value, [](double a, double b) { return a >= b; });
+    max_queue_.push(count_, value, [](double a, double b) { return a <= b; });
+    ++count_;
+
+    if (evictions_ == Capacity)
+      refresh();
+  }
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == Capacity; }
+  // samples pushed since clear(), including evicted ones
+  long count() const { return count_; }
+
+  // 0 when empty
+  double last() const { return size_ > 0 ? at(size_ - 1) : 0.0; }
+  // i = 0 is the oldest sample in the window
+  double at(int i) const { return values_[(head_ + i) % Capacity]; }
+
+  double sum() const { return sum_ + offset_ * size_; }
+  double mean() const { return size_ > 0 ? offset_ + sum_ / size_ : 0.0; }
+  double absMean() const { return size_ > 0 ? abs_sum_ / size_ : 0.0; }
+  // population variance of the window
+  double variance() const
+  {
+    if (size_ == 0)
+      return 0.0;
+    const double mean = sum_ / size_;
+    const double variance = square_sum_ / size_ - mean * mean;
+    return variance > 0.0 ? variance : 0.0;
+  }
+  double standardDeviation() const { return std::sqrt(variance()); }
+  double min() const { return size_ > 0 ? min_queue_.front() : 0.0; }
+  double max() const { return size_ > 0 ? max_queue_.front() : 0.0; }
+
+  // last minus previous sample, 0 with fewer than two
+  double difference() const { return size_ >= 2 ? at(size_ - 1) - at(size_ - 2) : 0.0; }
+  // backward difference for samples dt apart
+  double derivative(double dt) const { return difference() / dt; }
+
+ private:
+  // values whose successors are all larger (min) or smaller (max), with
+  // their sample index; the front is the extreme of the window
+  class MonotonicQueue
+  {
+   public:
+    void clear() { begin_ = end_ = 0; }
+
+    template <class Dominates>
+    void push(long index, double value, Dominates dominates)
+    {
+      while (end_ != begin_ && dominates(values_[(end_ - 1) % Capacity], value))
+        --end_;
+      indices_[end_ % Capacity] = index;
+      values_[end_ % Capacity] = value;
+      ++end_;
+    }
+
+    void dropBefore(long index)
+    {
+      while (end_ != begin_ && indices_[begin_ % Capacity] < index)
+        ++begin_;
+    }
+
+    double front() const { return values_[begin_ % Capacity]; }
+
+   private:
+    std::array<long, Capacity> indices_;
+    std::array<double, Capacity> values_;
+    long begin_{0};
+    long end_{0};
+  };
+
+  void refresh()
+  {
+    offset_ = last();
+    sum_ = abs_sum_ = square_sum_ = 0.0;
+    for (int i = 0; i < size_; ++i)
+    {
+      const double value = at(i);
+      const double shifted = value - offset_;
+      sum_ += shifted;
+      abs_sum_ += std::fabs(value);
+      square_sum_ += shifted * shifted;
+    }
+    evictions_ = 0;
+  }
+
+  std::array<double, Capacity> values_;
+  int size_;
+  int head_;
+  // sum_ and square_sum_ are of value - offset_
+  double offset_;
+  double sum_;
+  double abs_sum_;
+  double square_sum_;
+  int evictions_;
+  long count_;
+  MonotonicQueue min_queue_;
+  MonotonicQueue max_queue_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
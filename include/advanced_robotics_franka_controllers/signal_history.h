@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include <Eigen/Dense>
+
+namespace advanced_robotics_franka_controllers {
+
+// History of Channels signals sampled together (e.g. the contact normal and
+// position while approaching), stored channel by channel in one block that
+// allocate() sizes once, in init(). push() copies one sample and never
+// allocates. When the history is full it either overwrites the oldest sample
+// (kOverwriteOldest) or refuses new ones and counts them as dropped
+// (kStopRecording) until clear().
+//
+// channel() maps the stored samples of a channel without copying. With
+// kOverwriteOldest the samples may wrap around the end of the block, so a
+// view has two parts, older then newer; with kStopRecording, or before the
+// first overwrite, newer is empty.
+//
+//   init():   direction_history_.allocate(1000, SignalHistory<7>::kOverwriteOldest);
+//   update(): direction_history_.push(sample);
+//             const double mean = direction_history_.channel(kP).sum() / direction_history_.size();
+template <int Channels>
+class SignalHistory
+{
+  static_assert(Channels >= 1, "the history needs at least one channel");
+
+ public:
+  enum Policy
+  {
+    kOverwriteOldest,
+    kStopRecording
+  };
+
+  typedef Eigen::Matrix<double, Channels, 1> Sample;
+  typedef Eigen::Map<const Eigen::VectorXd> Segment;
+
+  struct View
+  {
+    Segment older;
+    Segment newer;
+
+    int size() const { return older.size() + newer.size(); }
+    // i = 0 is the oldest sample
+    double operator[](int i) const { return i < older.size() ? older(i) : newer(i - older.size()); }
+    double sum() const { return older.sum() + newer.sum(); }
+    double minCoeff() const
+    {
+      return newer.size() > 0 ? std::min(older.minCoeff(), newer.minCoeff()) : older.minCoeff();
+    }
+    double maxCoeff() const
+    {
+      return newer.size() > 0 ? std::max(older.maxCoeff(), newer.maxCoeff()) : older.maxCoeff();
+    }
+  };
+
+  // not realtime safe; drops the stored samples
+  void allocate(int capacity, Policy policy)
+  {
+    capacity_ = std::max(capacity, 1);
+    policy_ = policy;
+    arena_.reset(new double[static_cast<size_t>(capacity_) * Channels]);
+    std::fill(arena_.get(), arena_.get() + static_cast<size_t>(capacity_) * Channels, 0.0);
+    clear();
+  }
+
+  void clear()
+  {
+    head_ = 0;
+    size_ = 0;
+    dropped_ = 0;
+  }
+
+  // false if the sample was dropped (kStopRecording and full, or not allocated)
+  bool push(const Sample &sample)
+  {
+    if (size_ == capacity_)
+    {
+      if (policy_ == kStopRecording || capacity_ == 0)
+      {
+        ++dropped_;
+        return false;
+      }
+      head_ = head_ + 1 == capacity_ ? 0 : head_ + 1;
+      --size_;
+    }
+    int slot = head_ + size_;
+    if (slot >= capacity_)
+      slot -= capacity_;
+    for (int c = 0; c < Channels; ++c)
+      arena_[static_cast<size_t>(c) * capacity_ + slot] = sample(c);
+    ++size_;
+    return true;
+  }
+
+  View channel(int c) const
+  {
+    const double *data = arena_.get() + static_cast<size_t>(c) * capacity_;
+    const int older = std::min(size_, capacity_ - head_);
+    return View{Segment(data + head_, older), Segment(data, size_ - older)};
+  }
+
+  // i = 0 is the oldest sample
+  double at(int c, int i) const
+  {
+    int slot = head_ + i;
+    if (slot >= capacity_)
+      slot -= capacity_;
+    return arena_[static_cast<size_t>(c) * capacity_ + slot];
+  }
+  // 0 when empty
+  double last(int c) const { return size_ > 0 ? at(c, size_ - 1) : 0.0; }
+
+  int size() const { return size_; }
+  int capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == capacity_; }
+  // samples refused since clear()
+  long dropped() const { return dropped_; }
+  Policy policy() const { return policy_; }
+
+ private:
+  std::unique_ptr<double[]> arena_;
+  int capacity_{0};
+  Policy policy_{kOverwriteOldest};
+  int head_{0};
+  int size_{0};
+  long dropped_{0};
+};
+
+}  // namespace advanced_robotics_franka_controllers
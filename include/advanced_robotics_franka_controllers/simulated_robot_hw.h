@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <franka/robot_state.h>
+#include <franka_hw/model_base.h>
+#include <hardware_interface/controller_info.h>
+#include <ros/time.h>
+
+#include <advanced_robotics_franka_controllers/franka_interface_hw.h>
+
+template <int DOF>
+class RobotModel;
+
+namespace advanced_robotics_franka_controllers {
+
+// franka_hw model backed by RobotModel (RBDL).
+// kFlange, kEndEffector and kStiffness follow the franka frame definitions;
+// the joint frames are the RBDL body frames, which are not DH aligned.
+class SimulatedModel : public franka_hw::ModelBase
+{
+ public:
+  SimulatedModel();
+  ~SimulatedModel() override;
+
+  std::array<double, 16> pose(franka::Frame frame, const std::array<double, 7> &q,
+                              const std::array<double, 16> &F_T_EE,
+                              const std::array<double, 16> &EE_T_K) const override;
+  std::array<double, 42> bodyJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                      const std::array<double, 16> &F_T_EE,
+                                      const std::array<double, 16> &EE_T_K) const override;
+  std::array<double, 42> zeroJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                      const std::array<double, 16> &F_T_EE,
+                                      const std::array<double, 16> &EE_T_K) const override;
+  std::array<double, 49> mass(const std::array<double, 7> &q, const std::array<double, 9> &I_total,
+                              double m_total, const std::array<double, 3> &F_x_Ctotal) const override;
+  std::array<double, 7> coriolis(const std::array<double, 7> &q, const std::array<double, 7> &dq,
+                                 const std::array<double, 9> &I_total, double m_total,
+                                 const std::array<double, 3> &F_x_Ctotal) const override;
+  std::array<double, 7> gravity(const std::array<double, 7> &q, double m_total,
+                                const std::array<double, 3> &F_x_Ctotal,
+                                const std::array<double, 3> &gravity_earth) const override;
+
+  // joint accelerations for the applied (gravity included) joint torques
+  std::array<double, 7> forwardDynamics(const std::array<double, 7> &q, const std::array<double, 7> &dq,
+                                        const std::array<double, 7> &tau) const;
+
+ private:
+  void updateKinematics(const std::array<double, 7> &q, const std::array<double, 7> &dq) const;
+
+  std::unique_ptr<RobotModel<7>> robot_;
+};
+
+// Hardware-free panda. Integrates the RobotModel dynamics by one fixed step
+// per write().
+//
+// The torque interface is gravity compensated like the real robot. Position
+// and velocity commands are tracked by an internal joint impedance, which also
+// holds the arm while no controller is running.
+class SimulatedRobotHW : public FrankaInterfaceHW
+{
+ public:
+  SimulatedRobotHW(const std::string &arm_id, const std::vector<std::string> &joint_names,
+                   const std::array<double, 7> &q_init);
+
+  bool prepareSwitch(const std::list<hardware_interface::ControllerInfo> &start_list,
+                     const std::list<hardware_interface::ControllerInfo> &stop_list) override;
+  void doSwitch(const std::list<hardware_interface::ControllerInfo> &start_list,
+                const std::list<hardware_interface::ControllerInfo> &stop_list) override;
+
+  void read(const ros::Time &time, const ros::Duration &period) override;
+  void write(const ros::Time &time, const ros::Duration &period) override;
+
+  const SimulatedModel &model() const { return model_; }
+
+ private:
+  enum class ControlMode
+  {
+    kNone,
+    kEffort,
+    kPosition,
+    kVelocity
+  };
+
+  static ControlMode controlMode(const hardware_interface::ControllerInfo &info);
+  void hold();
+
+  SimulatedModel model_;
+  ControlMode mode_{ControlMode::kNone};
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,81 @@
+#pragma once
+
+namespace advanced_robotics_franka_controllers {
+
+// Streaming least squares fit of y = slope * t + offset, O(1) per sample and
+// per query, no history kept. With forgetting factor lambda < 1 each older
+// sample is weighted down by lambda per new one (recursive least squares
+// with exponential forgetting, effective window 1 / (1 - lambda) samples);
+// lambda = 1 is the ordinary fit over every sample since reset(), the same
+// line DyrosMath::leastSquareLinear fits over a stored vector.
+//
+// The weighted sums are kept about the newest sample time, so they stay
+// well conditioned however long the run is.
+//
+//   update(): moment_slope_.add(time.toSec(), m(0));
+//   done:     if (std::fabs(moment_slope_.slope()) < 0.1) ...
+class SlopeEstimator
+{
+ public:
+  explicit SlopeEstimator(double forgetting_factor = 1.0) : lambda_(forgetting_factor) {}
+
+  void reset()
+  {
+    count_ = 0;
+    w_ = st_ = stt_ = sy_ = sty_ = 0.0;
+  }
+
+  void add(double time, double value)
+  {
+    if (count_ > 0)
+    {
+      // move the origin of the sums to the new sample time
+      const double shift = time - last_time_;
+      stt_ -= shift * (2.0 * st_ - shift * w_);
+      st_ -= shift * w_;
+      sty_ -= shift * sy_;
+
+      w_ *= lambda_;
+      st_ *= lambda_;
+      stt_ *= lambda_;
+      sy_ *= lambda_;
+      sty_ *= lambda_;
+    }
+    last_time_ = time;
+    ++count_;
+    w_ += 1.0;
+    sy_ += value;
+  }
+
+  // 0 until two distinct sample times have been added
+  double slope() const
+  {
+    const double det = w_ * stt_ - st_ * st_;
+    return det > 0.0 ? (w_ * sty_ - st_ * sy_) / det : 0.0;
+  }
+
+  // the fitted line at the newest sample time
+  double value() const
+  {
+    if (count_ == 0)
+      return 0.0;
+    return (sy_ - slope() * st_) / w_;
+  }
+
+  int count() const { return count_; }
+  double forgettingFactor() const { return lambda_; }
+  void setForgettingFactor(double forgetting_factor) { lambda_ = forgetting_factor; }
+
+ private:
+  double lambda_;
+  int count_{0};
+  double last_time_{0.0};
+  // weighted sums of 1, t, t^2, y and t y with t relative to last_time_
+  double w_{0.0};
+  double st_{0.0};
+  double stt_{0.0};
+  double sy_{0.0};
+  double sty_{0.0};
+};
+
+}  // namespace advanced_robotics_franka_controllers
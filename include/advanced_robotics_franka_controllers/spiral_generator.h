@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Dense>
+
+namespace advanced_robotics_franka_controllers {
+
+// Rotates the unit vector (c, s) by angle. Below 0.05 rad cos/sin are
+// replaced by their series; the cos term is off by ~2e-11 at 0.05 rad and
+// by less than 1e-20 at the sub-milliradian steps of a search.
+inline void rotateUnit(double angle, double &c, double &s)
+{
+  const double a2 = angle * angle;
+  double cos_a, sin_a;
+  if (a2 < 0.0025)
+  {
+    cos_a = 1.0 - 0.5 * a2 * (1.0 - a2 / 12.0);
+    sin_a = angle * (1.0 - a2 / 6.0 * (1.0 - a2 / 20.0));
+  }
+  else
+  {
+    cos_a = std::cos(angle);
+    sin_a = std::sin(angle);
+  }
+  const double c_next = c * cos_a - s * sin_a;
+  s = s * cos_a + c * sin_a;
+  c = c_next;
+}
+
+// Archimedean search spiral r = b phi, b = pitch / 2 pi, walked at a path
+// speed, as a stateful generator. DyrosMath::spiral recomputes sqrt, cos and
+// sin from the absolute time; here each tick turns the arc length v dt into
+// dphi = v dt / sqrt(r^2 + b^2), grows r by b dphi and rotates the heading
+// (c, s) by dphi, renormalizing it every kRenormalizeInterval steps.
+// Pitch and speed only set the next increments, so setPitch() and
+// setLinearVelocity() retune the search without a jump in the setpoint.
+// scale() stretches the axes like DyrosMath::ellipseSpiral.
+//
+//   spiral start: spiral_.reset(position.head<2>(), 0.005, 0.002, 40.0);
+//   update():     x_desired_.head<2>() = spiral_.advance(period.toSec());
+class SpiralGenerator
+{
+ public:
+  static constexpr int kRenormalizeInterval = 64;
+
+  SpiralGenerator() { reset(Eigen::Vector2d::Zero(), 0.0, 0.001, 0.0); }
+
+  // starts at origin with the first turn heading along +x; the spiral stops
+  // (and holds its last point) after duration seconds
+  void reset(const Eigen::Vector2d &origin, double linear_velocity, double pitch, double duration)
+  {
+    origin_ = origin;
+    point_ = origin;
+    scale_.setOnes();
+    linear_velocity_ = linear_velocity;
+    setPitch(pitch);
+    duration_ = duration;
+    elapsed_ = 0.0;
+    radius_ = 0.0;
+    angle_ = 0.0;
+    c_ = 1.0;
+    s_ = 0.0;
+    steps_ = 0;
+  }
+
+  const Eigen::Vector2d &advance(double dt)
+  {
+    dt = std::min(dt, duration_ - elapsed_);
+    if (dt <= 0.0)
+      return point_;
+    elapsed_ += dt;
+
+    const double angle_step = linear_velocity_ * dt / std::sqrt(radius_ * radius_ + b_ * b_);
+    radius_ += b_ * angle_step;
+    angle_ += angle_step;
+    rotateUnit(angle_step, c_, s_);
+    if (++steps_ == kRenormalizeInterval)
+    {
+      // first order Newton step towards |(c, s)| = 1
+      const double k = 1.5 - 0.5 * (c_ * c_ + s_ * s_);
+      c_ *= k;
+      s_ *= k;
+      steps_ = 0;
+    }
+
+    point_(0) = origin_(0) + scale_(0) * radius_ * c_;
+    point_(1) = origin_(1) + scale_(1) * radius_ * s_;
+    return point_;
+  }
+
+  void setLinearVelocity(double linear_velocity) { linear_velocity_ = linear_velocity; }
+  // the radius is kept, the remaining turns get the new spacing
+  void setPitch(double pitch) { b_ = pitch / (2.0 * M_PI); }
+  void setDuration(double duration) { duration_ = duration; }
+  // takes effect at the next advance(); a non unit scale moves the point
+  void scale(double x, double y) { scale_ << x, y; }
+
+  const Eigen::Vector2d &position() const { return point_; }
+  double radius() const { return radius_; }
+  // accumulated polar angle, not wrapped
+  double angle() const { return angle_; }
+  double elapsed() const { return elapsed_; }
+  bool done() const { return elapsed_ >= duration_; }
+
+ private:
+  Eigen::Vector2d origin_;
+  Eigen::Vector2d point_;
+  Eigen::Vector2d scale_;
+  double linear_velocity_;
+  double b_;
+  double duration_;
+  double elapsed_;
+  double radius_;
+  double angle_;
+  double c_;
+  double s_;
+  int steps_;
+};
+
+// amplitude * sin(phase), e.g. the orientation wiggle of a peg search, from a
+// phase accumulator. The rotation by omega dt is exact (cos/sin are taken
+// once per frequency or period change) and the unit vector is renormalized
+// every kRenormalizeInterval steps. setFrequency() keeps the phase;
+// setAmplitude() slews towards the new amplitude at a bounded rate so the
+// output stays continuous.
+class OscillationGenerator
+{
+ public:
+  static constexpr int kRenormalizeInterval = 64;
+
+  OscillationGenerator() { reset(0.0, 0.0, 0.001); }
+
+  void reset(double amplitude, double frequency, double dt, double phase = 0.0)
+  {
+    amplitude_ = amplitude;
+    target_amplitude_ = amplitude;
+    amplitude_rate_ = 0.0;
+    frequency_ = frequency;
+    dt_ = dt;
+    c_ = std::cos(phase);
+    s_ = std::sin(phase);
+    steps_ = 0;
+    updateStep();
+  }
+
+  // one period dt of the controller; returns the new value
+  double advance()
+  {
+    const double c_next = c_ * step_c_ - s_ * step_s_;
+    s_ = s_ * step_c_ + c_ * step_s_;
+    c_ = c_next;
+    if (++steps_ == kRenormalizeInterval)
+    {
+      const double k = 1.5 - 0.5 * (c_ * c_ + s_ * s_);
+      c_ *= k;
+      s_ *= k;
+      steps_ = 0;
+    }
+
+    if (amplitude_ != target_amplitude_)
+    {
+      const double max_change = amplitude_rate_ * dt_;
+      amplitude_ += std::max(-max_change, std::min(max_change, target_amplitude_ - amplitude_));
+    }
+    return value();
+  }
+
+  // rate is in amplitude units per second; rate <= 0 switches immediately
+  void setAmplitude(double amplitude, double rate)
+  {
+    target_amplitude_ = amplitude;
+    amplitude_rate_ = rate;
+    if (rate <= 0.0)
+      amplitude_ = amplitude;
+  }
+  void setFrequency(double frequency)
+  {
+    frequency_ = frequency;
+    updateStep();
+  }
+  void setPeriod(double dt)
+  {
+    dt_ = dt;
+    updateStep();
+  }
+
+  double value() const { return amplitude_ * s_; }
+  // d/dt of value() at constant amplitude
+  double velocity() const { return amplitude_ * 2.0 * M_PI * frequency_ * c_; }
+  double amplitude() const { return amplitude_; }
+  double frequency() const { return frequency_; }
+
+ private:
+  void updateStep()
+  {
+    const double step = 2.0 * M_PI * frequency_ * dt_;
+    step_c_ = std::cos(step);
+    step_s_ = std::sin(step);
+  }
+
+  double amplitude_;
+  double target_amplitude_;
+  double amplitude_rate_;
+  double frequency_;
+  double dt_;
+  double step_c_;
+  double step_s_;
+  double c_;
+  double s_;
+  int steps_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
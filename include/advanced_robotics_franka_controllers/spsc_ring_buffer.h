@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace advanced_robotics_franka_controllers {
+
+// Single producer / single consumer queue of fixed capacity.
+// Storage is allocated once in reserve() (call it from init(), never from
+// update()); push() and pop() are wait-free and never allocate.
+template <typename T>
+class SpscRingBuffer
+{
+ public:
+  // Capacity is rounded up to a power of two.
+  void reserve(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    buffer_.assign(size, T());
+    mask_ = size - 1;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return buffer_.size(); }
+
+  // Producer side. Returns false when the buffer is full.
+  bool push(const T &item)
+  {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= buffer_.size())
+      return false;
+    buffer_[tail & mask_] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when the buffer is empty.
+  bool pop(T &item)
+  {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+      return false;
+    item = buffer_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const
+  {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<T> buffer_;
+  size_t mask_{0};
+
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace advanced_robotics_franka_controllers
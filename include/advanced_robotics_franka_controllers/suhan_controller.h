@@ -5,7 +5,9 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/spiral_generator.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -20,25 +22,25 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class SuhanController : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class SuhanController : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
+ private:
   enum class ControlType
   {
     None, PathFollowing, Assembly1, Assembly2
   };
 
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
   void initTasks();
   void getTrajectories();
 
   Eigen::Matrix<double, 7, 1> movePathUpdate(const ros::Time& time, Eigen::Matrix<double, 7, 1> target_pos);
-  Eigen::Matrix<double, 7, 1> assembleUpdate(const ros::Time& time, SuhanController::ControlType assembly_type);
+  Eigen::Matrix<double, 7, 1> assembleUpdate(const ros::Time& time, const ros::Duration& period, SuhanController::ControlType assembly_type);
 
   std::vector<std::pair<double , ControlType>> tasks_; // time, ctr type
   int task_index_ {0};
@@ -46,9 +48,6 @@ class SuhanController : public controller_interface::MultiInterfaceController<
 
   ControlType time2task(const ros::Time& time);
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
 
@@ -58,6 +57,7 @@ class SuhanController : public controller_interface::MultiInterfaceController<
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
 
   
@@ -65,6 +65,7 @@ class SuhanController : public controller_interface::MultiInterfaceController<
   Eigen::Matrix<double, 3, 3> ori_init_assembly_;
   double time_starting_assembly_;
   Eigen::Vector3d spiral_starting_pos_assembly_;
+  SpiralGenerator spiral_;
 
 };
 
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <advanced_robotics_franka_controllers/spsc_ring_buffer.h>
+
+namespace advanced_robotics_franka_controllers {
+
+struct TelemetryRecord
+{
+  static constexpr size_t kMaxFields = 16;
+
+  uint32_t channel;
+  uint32_t size;
+  double data[kMaxFields];
+};
+
+// Binary data logger for the real-time loop.
+// Channels are registered in init(), then open() preallocates the queue and
+// starts a writer thread. record() only copies the values into the queue;
+// the writer thread drains it to disk in large sequential writes.
+// scripts/telemetry_to_txt.py converts a recording back to one tab separated
+// text file per channel.
+//
+// File layout (little endian):
+//   "ARFT" | uint32 version | uint32 channel count
+//   per channel: uint32 field count | uint32 name length | name
+//   records:     uint32 channel | field count x double
+class TelemetryRecorder
+{
+ public:
+  ~TelemetryRecorder();
+
+  // Returns the channel id, or -1 if the recorder is already open
+  // or the channel has more than TelemetryRecord::kMaxFields fields.
+  int addChannel(const std::string &name, size_t fields);
+
+  bool open(const std::string &file_name, size_t capacity = 8192);
+  void close();
+  bool isOpen() const { return running_.load(std::memory_order_acquire); }
+
+  // Real-time safe. Returns false if the record was dropped.
+  bool recordArray(int channel, const double *data, size_t size);
+
+  template <typename... Args>
+  bool record(int channel, Args... values)
+  {
+    const double data[] = {static_cast<double>(values)...};
+    return recordArray(channel, data, sizeof...(Args));
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  void writerLoop();
+  size_t drain();
+
+  struct Channel
+  {
+    std::string name;
+    uint32_t fields;
+  };
+  std::vector<Channel> channels_;
+
+  SpscRingBuffer<TelemetryRecord> queue_;
+  std::vector<char> write_buffer_;
+  FILE *file_{nullptr};
+
+  std::thread writer_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/gripper_dispatcher.h>
+#include <advanced_robotics_franka_controllers/realtime_mailbox.h>
+#include <advanced_robotics_franka_controllers/realtime_stream.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -35,14 +38,11 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerAssemblyStrategy : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class TorqueJointSpaceControllerAssemblyStrategy : public TorqueControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
   void commandForceCallback(const geometry_msgs::WrenchConstPtr& msg);
   void pegInHoleStateCallback(const std_msgs::Int32ConstPtr& msg);
@@ -52,13 +52,11 @@ class TorqueJointSpaceControllerAssemblyStrategy : public controller_interface::
   void planDoneCallback(const std_msgs::Bool& msg);
   void gripperCloseCallback(const std_msgs::Bool& msg);
   void gripperOpenCallback(const std_msgs::Bool& msg);
+  void receiveCommands();
 
   int assem;
   
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
 
@@ -79,9 +77,9 @@ class TorqueJointSpaceControllerAssemblyStrategy : public controller_interface::
 
 
 //----------------------------------------------------------------------------------
-  ros::Publisher current_pose_pub_;
-  ros::Publisher current_twist_pub_; //linear + angular
-  ros::Publisher current_wrench_pub_;
+  RealtimeStream<geometry_msgs::Pose> current_pose_stream_;
+  RealtimeStream<geometry_msgs::Twist> current_twist_stream_; //linear + angular
+  RealtimeStream<geometry_msgs::Wrench> current_wrench_stream_;
 	  
   ros::Subscriber f_star_zero_sub_;
   ros::Subscriber peg_in_hole_state_sub_;
@@ -92,14 +90,7 @@ class TorqueJointSpaceControllerAssemblyStrategy : public controller_interface::
   std_msgs::Float32MultiArray current_orientation_info_;
   geometry_msgs::Wrench current_force_info_;
   geometry_msgs::Wrench current_torque_info_;
-    
-  geometry_msgs::Pose current_pose_info_;
-  geometry_msgs::Twist current_twist_info_;
-  geometry_msgs::Wrench current_wrench_info_;  
   
-  franka_gripper::GraspGoal close_goal;
-  franka_gripper::MoveGoal open_goal;
-  franka_gripper::GraspEpsilon epsilon;
 
 
   Eigen::Matrix<double, 6, 1> f_star_zero_;
@@ -134,10 +125,16 @@ class TorqueJointSpaceControllerAssemblyStrategy : public controller_interface::
   ros::Subscriber gripper_close_sub_;
   ros::Subscriber gripper_open_sub_;
 
-  actionlib::SimpleActionClient<franka_gripper::GraspAction> gripper_ac_close
-  {"/franka_gripper/grasp", true};
-  actionlib::SimpleActionClient<franka_gripper::MoveAction> gripper_ac_open
-  {"/franka_gripper/move", true};
+  // subscriber inputs, taken over by receiveCommands()
+  RealtimeMailbox<Eigen::Matrix<double, 6, 1>> f_star_zero_in_;
+  RealtimeMailbox<int> peg_in_hole_state_in_;
+  RealtimeMailbox<bool> task_start_in_;
+  RealtimeMailbox<Eigen::Matrix<double, 7, 1>> trajectory_in_;
+  RealtimeMailbox<bool> planned_done_in_;
+  RealtimeMailbox<bool> gripper_close_in_;
+  RealtimeMailbox<bool> gripper_open_in_;
+
+  GripperDispatcher gripper_;
 
 };
 
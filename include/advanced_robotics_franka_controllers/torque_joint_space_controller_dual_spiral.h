@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/gripper_dispatcher.h>
+#include <advanced_robotics_franka_controllers/spiral_generator.h>
+#include <advanced_robotics_franka_controllers/telemetry_recorder.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -26,14 +29,11 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerDualSpiral : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class TorqueJointSpaceControllerDualSpiral : public TorqueControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
   void approach(Eigen::Vector3d position, Eigen::Matrix<double, 6, 1> xd, Eigen::Matrix3d ori);
   void search(const Eigen::Vector3d position, const Eigen::Matrix3d rotation, const Eigen::Matrix<double, 6, 1> xd);
   void insert(const Eigen::Vector3d position, const Eigen::Matrix3d rotation, const Eigen::Matrix<double, 6, 1> xd);
@@ -41,9 +41,6 @@ class TorqueJointSpaceControllerDualSpiral : public controller_interface::MultiI
   void gripperOpen();
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
@@ -61,16 +58,12 @@ class TorqueJointSpaceControllerDualSpiral : public controller_interface::MultiI
   Eigen::Matrix<double , 12, 1> x_temp_;
 
 
-  FILE *joint0_data;
-  FILE *save_data_x;
-  FILE *save_data_x2;
-  FILE *force_moment_ee;
-  FILE *cmd_task_space;
-  FILE *cmd_joint_space;
-
-  FILE *save_force;
-  FILE *save_position;
-  FILE *save_velocity;
+  TelemetryRecorder telemetry_;
+  int force_moment_channel_;
+  int position_channel_;
+  int f_measured_channel_;
+  int cmd_task_space_channel_;
+  int cmd_joint_space_channel_;
 
   Eigen::Vector3d target_x_;
   Eigen::Vector3d x_desired_;
@@ -110,8 +103,7 @@ class TorqueJointSpaceControllerDualSpiral : public controller_interface::MultiI
 
   ros::Duration finish_time;
 
-  actionlib::SimpleActionClient<franka_gripper::MoveAction> gripper_ac_
-  {"/franka_gripper/move", true};
+  GripperDispatcher gripper_;
 
   // //actionlib::SimpleActionClient<franka_gripper::Grasp> gripper_grasp_
   // //{"/franka_gripper/grasp", true};
@@ -134,7 +126,6 @@ class TorqueJointSpaceControllerDualSpiral : public controller_interface::MultiI
   bool is_search_first_;
   bool is_insert_first_;
   bool is_release_first_;
-  bool is_first_;
   bool is_ready_;
   
   bool is_approach_done_;
@@ -143,12 +134,12 @@ class TorqueJointSpaceControllerDualSpiral : public controller_interface::MultiI
   bool is_release_done_;
 
   ros::Time cur_time_;
-  ros::Time spiral_start_time_;
+  ros::Duration cur_period_;
   ros::Time insert_start_time_;
   ros::Time release_start_time_;
-  ros::Time ori_start_time_;
 
-  int ori_change_dir_;
+  SpiralGenerator spiral_;
+  OscillationGenerator wiggle_;
 
   int smoothing_tick_ = 0;
   int hz_ = 1000;
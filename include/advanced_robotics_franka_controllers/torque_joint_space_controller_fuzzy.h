@@ -4,7 +4,8 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/spiral_generator.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -34,14 +35,11 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerFuzzy : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class TorqueJointSpaceControllerFuzzy : public TorqueControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
   void approach(Eigen::Vector3d position, Eigen::Matrix<double, 6, 1> xd, Eigen::Matrix3d ori);
   void search(const Eigen::Vector3d position, const Eigen::Matrix3d rotation, const Eigen::Matrix<double, 6, 1> xd);
   void insert(const Eigen::Vector3d position, const Eigen::Matrix3d rotation, const Eigen::Matrix<double, 6, 1> xd);
@@ -53,9 +51,6 @@ class TorqueJointSpaceControllerFuzzy : public controller_interface::MultiInterf
   void gripperOpen();
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
@@ -135,8 +130,10 @@ class TorqueJointSpaceControllerFuzzy : public controller_interface::MultiInterf
 
 
   ros::Time cur_time_;
+  ros::Duration cur_period_;
   ros::Time approach_start_time_;
   ros::Time spiral_start_time_;
+  SpiralGenerator spiral_;
   ros::Time insert_start_time_;
   ros::Time release_start_time_;
   ros::Time escape_start_time_;
@@ -4,7 +4,9 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/running_statistics.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -21,14 +23,14 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerHip : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class TorqueJointSpaceControllerHip : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
   void approach(double current_force, double threshold, Eigen::Vector3d x, Eigen::Matrix<double, 6, 1> xd, Eigen::Matrix3d ori);
   void rasterSearch(Eigen::Vector3d x, Eigen::Matrix<double, 6, 1> xd, Eigen::Matrix3d rot);
@@ -38,9 +40,6 @@ class TorqueJointSpaceControllerHip : public controller_interface::MultiInterfac
   void verify(const Eigen::Vector3d force_ee, const double threshold, Eigen::Vector3d x, Eigen::Matrix<double, 6, 1> xd, Eigen::Matrix3d ori);
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
   
 
   ros::Time start_time_;
@@ -49,6 +48,7 @@ class TorqueJointSpaceControllerHip : public controller_interface::MultiInterfac
   franka_hw::TriggerRate data_save_trigger_{1}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
   Eigen::Vector3d pos_init_;
   Eigen::Matrix<double, 3, 3> ori_init_;
@@ -65,7 +65,7 @@ class TorqueJointSpaceControllerHip : public controller_interface::MultiInterfac
 
   Eigen::Vector3d goal_position_;
   Eigen::Vector3d check_assembly_; // check assembly state along x, y,z direction w.r.t EE
-  std::vector<double> fx_ee_;
+  RunningStatistics<100> fx_ee_;
   
   int cnt_ = 1;
   int sgn_ = -1;
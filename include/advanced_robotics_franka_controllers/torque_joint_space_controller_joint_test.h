@@ -4,7 +4,9 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/gripper_dispatcher.h>
+#include <advanced_robotics_franka_controllers/spiral_generator.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -45,14 +47,11 @@ enum STATE {
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerJointTest : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class TorqueJointSpaceControllerJointTest : public TorqueControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
   void ready(const Eigen::Vector3d position, const Eigen::Matrix3d rotation, const Eigen::Matrix<double, 6, 1> xd,
               const Eigen::Matrix<double, 6, 1> f_measured, const Eigen::Matrix3d base_rotation);
   void tilt(const Eigen::Vector3d position, const Eigen::Matrix<double, 6, 1> xd, const Eigen::Matrix3d rotation,
@@ -66,17 +65,15 @@ class TorqueJointSpaceControllerJointTest : public controller_interface::MultiIn
   void gripperClose();
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
   
 
   ros::Time start_time_;
   ros::Time cur_time_;
+  ros::Duration cur_period_;
   ros::Time tilt_start_time_;
   ros::Time moveback_start_time_;
   ros::Time approach_start_time_;
-  ros::Time spiral_start_time_;
+  SpiralGenerator spiral_;
   ros::Time insert_start_time_;
   ros::Time release_start_time_;
 
@@ -147,8 +144,7 @@ class TorqueJointSpaceControllerJointTest : public controller_interface::MultiIn
 
   Eigen::Matrix4d T_GA_;
   
-  actionlib::SimpleActionClient<franka_gripper::GraspAction> gripper_ac_close_
-  {"/franka_gripper/grasp", true};
+  GripperDispatcher gripper_;
 };
 
 }  // namespace advanced_robotics_franka_controllers
@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/signal_history.h>
+#include <advanced_robotics_franka_controllers/slope_estimator.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -32,14 +35,14 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerPlace : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class TorqueJointSpaceControllerPlace : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
   void initConfig(const ros::Time& time, const Eigen::Vector3d position, const Eigen::Matrix3d rotation_M, const Eigen::Matrix<double, 6, 1> x_dot_);
   void approach(const ros::Time& time, const Eigen::Vector3d position, const Eigen::Matrix3d rotation_M, const Eigen::Matrix<double, 6, 1> x_dot_);
   void alignAxis(const ros::Time& time, const Eigen::Vector3d position, const Eigen::Matrix3d rotation_M, const Eigen::Matrix<double, 6, 1> x_dot_, const double duration);
@@ -47,15 +50,12 @@ class TorqueJointSpaceControllerPlace : public controller_interface::MultiInterf
   void getInitialFT(const int index);
   void getDirectionVector(const Eigen::Vector3d position, const Eigen::Matrix3d rotation);
   void clearDirectionVector();
-  void getMoment(const Eigen::Matrix<double, 6, 1> f, const Eigen::Matrix<double, 6, 1> f_ee);
+  void getMoment(const ros::Time& time, const Eigen::Matrix<double, 6, 1> f, const Eigen::Matrix<double, 6, 1> f_ee);
   void clearMoment();
   void saveReasult();
   void forceSmoothing(const Eigen::Vector3d goal_f, Eigen::Vector3d cur_f, const ros::Time& cur_time, const double duration);
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
@@ -66,6 +66,7 @@ class TorqueJointSpaceControllerPlace : public controller_interface::MultiInterf
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
   Eigen::Vector3d pos_init_;
   Eigen::Matrix<double, 3, 3> ori_init_;
@@ -149,21 +150,16 @@ class TorqueJointSpaceControllerPlace : public controller_interface::MultiInterf
   int contact_points_;
   int revolve_direction_;
 
-  std::vector<double> nx_;
-  std::vector<double> ny_;
-  std::vector<double> nz_;
-  std::vector<double> ex_;
-  std::vector<double> ey_;
-  std::vector<double> ez_;
-  std::vector<double> p_;
-
-  std::vector<double> mx_;
-  std::vector<double> my_;
-  std::vector<double> mz_;
-  std::vector<double> mx_ee_;
-  std::vector<double> my_ee_;
-  std::vector<double> mz_ee_;
-  std::vector<double> t_;
+  // contact normal n, end effector position e and plane offset p = n . e
+  // of every tick in contact since clearDirectionVector()
+  enum DirectionChannel { kNx, kNy, kNz, kEx, kEy, kEz, kP, kDirectionChannels };
+  SignalHistory<kDirectionChannels> direction_history_;
+
+  // latest moments in the base and ee frames, and the slope of the ee
+  // moments since clearMoment()
+  Eigen::Vector3d moment_;
+  Eigen::Vector3d moment_ee_;
+  SlopeEstimator moment_slope_[3];
 };
 
 static Eigen::Matrix<double, 6, 1> straightApproach(const Eigen::Vector3d origin,
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
+#include <advanced_robotics_franka_controllers/realtime_mailbox.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -21,22 +24,19 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerRealsense : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class TorqueJointSpaceControllerRealsense : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
   void targePointCallback(const geometry_msgs::PoseArrayPtr &msg);
 
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
   
   ros::Subscriber target_3d_points_sub_;
   ros::Time start_time_;
@@ -44,6 +44,7 @@ class TorqueJointSpaceControllerRealsense : public controller_interface::MultiIn
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
   Eigen::Vector3d pos_init_;
   Eigen::Matrix<double, 3, 3> ori_init_;
@@ -64,9 +65,14 @@ class TorqueJointSpaceControllerRealsense : public controller_interface::MultiIn
   Eigen::Matrix4d uni_T_obj_;
   Eigen::Matrix4d uni_T_ee_;
 
-  std::vector<double> obj_x_;
-  std::vector<double> obj_y_;
-  std::vector<double> obj_z_;
+  // object positions of the latest /target_3d_points_topic message, camera frame
+  struct TargetPoints
+  {
+    static constexpr size_t kMaxPoints = 16;
+    size_t count{0};
+    std::array<Eigen::Vector3d, kMaxPoints> points;
+  };
+  RealtimeMailbox<TargetPoints> targets_in_;
 
   FILE *joint0_data;
 
@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
+#include <advanced_robotics_franka_controllers/gripper_dispatcher.h>
+#include <advanced_robotics_franka_controllers/realtime_mailbox.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -36,14 +39,14 @@
 namespace advanced_robotics_franka_controllers {
 using namespace Eigen;
 
-class TorqueJointSpaceControllerRRT : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class TorqueJointSpaceControllerRRT : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
  void traj_cb(const sensor_msgs::JointStateConstPtr& msg);
   void planned_cb(const std_msgs::Bool& msg);
   void grip_cb(const std_msgs::Bool& msg);
@@ -53,18 +56,13 @@ class TorqueJointSpaceControllerRRT : public controller_interface::MultiInterfac
   void commandForceCallback(const geometry_msgs::WrenchConstPtr& msg);
   void pegInHoleStateCallback(const std_msgs::Int32ConstPtr& msg);
   void taskStartCallback(const std_msgs::Bool& msg);
+  void receiveCommands();
 ///////////////////////////////////////////
 
 
-  Matrix3d Rotate_with_X(const double rAngle);
-Matrix3d Rotate_with_Y(const double rAngle);
-Matrix3d Rotate_with_Z(const double rAngle);
 
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
   
   bool planned_done;
 
@@ -92,6 +90,15 @@ Matrix3d Rotate_with_Z(const double rAngle);
   ros::Subscriber f_star_zero_sub_;
   ros::Subscriber peg_in_hole_state_sub_;
   ros::Subscriber task_start_sub_;
+
+  // subscriber inputs, taken over by receiveCommands()
+  RealtimeMailbox<Eigen::Matrix<double, 7, 1>> trajectory_in_;
+  RealtimeMailbox<bool> planned_done_in_;
+  RealtimeMailbox<bool> gripper_close_in_;
+  RealtimeMailbox<bool> gripper_open_in_;
+  RealtimeMailbox<Eigen::Matrix<double, 6, 1>> f_star_zero_in_;
+  RealtimeMailbox<int> peg_in_hole_state_in_;
+  RealtimeMailbox<bool> task_start_in_;
     
   std_msgs::Float32MultiArray current_velocity_info_;
   geometry_msgs::Point current_position_info_;
@@ -136,6 +143,7 @@ Matrix3d Rotate_with_Z(const double rAngle);
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
   Eigen::Vector3d pos_init_;
   Eigen::Matrix<double, 3, 3> ori_init_;
@@ -147,10 +155,7 @@ Matrix3d Rotate_with_Z(const double rAngle);
 
   FILE *joint0_data;
 
-  actionlib::SimpleActionClient<franka_gripper::GraspAction> gripper_ac_
-  {"/franka_gripper/grasp", true};
-  actionlib::SimpleActionClient<franka_gripper::MoveAction> gripper_ac_open
-  {"/franka_gripper/move", true};
+  GripperDispatcher gripper_;
 };
 
 }  // namespace advanced_robotics_franka_controllers
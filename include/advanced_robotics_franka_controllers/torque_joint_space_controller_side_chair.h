@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/signal_history.h>
+#include <advanced_robotics_franka_controllers/slope_estimator.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -32,29 +35,26 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerSideChair : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
-                     
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+class TorqueJointSpaceControllerSideChair : public TorqueControllerBase {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
   void approach(const ros::Time& time, const Eigen::Vector3d position, const Eigen::Matrix3d rotation_M, const Eigen::Matrix<double, 6, 1> x_dot_);
   void revolve(const ros::Time& time, const Eigen::Vector3d axis, const Eigen::Vector3d position, const Eigen::Matrix3d rotation_M, const Eigen::Matrix<double, 6, 1> x_dot_, const double range, const double duration);
   void keepState(const ros::Time& time, const Eigen::Vector3d position, const Eigen::Matrix3d rotation_M, const Eigen::Matrix<double, 6, 1> x_dot_);
   void getInitialFT(const int index);
   void getDirectionVector(const Eigen::Vector3d position, const Eigen::Matrix3d rotation);
   void clearDirectionVector();
-  void getMoment(const Eigen::Matrix<double, 6, 1> f, const Eigen::Matrix<double, 6, 1> f_ee);
-  void clearMoment();
+  void getMoment(const ros::Time& time, const Eigen::Matrix<double, 6, 1> f, const Eigen::Matrix<double, 6, 1> f_ee);
+  void clearMoment(const double split_time);
   void saveReasult();
   void forceSmoothing(const Eigen::Vector3d goal_f, Eigen::Vector3d cur_f, const ros::Time& cur_time, const double duration);
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
@@ -65,6 +65,7 @@ class TorqueJointSpaceControllerSideChair : public controller_interface::MultiIn
   franka_hw::TriggerRate print_rate_trigger_{10}; 
 									   
   Eigen::Matrix<double, 7, 1> q_init_;
+  MultiCubicSegment<7> homing_;
   Eigen::Affine3d transform_init_;
   Eigen::Vector3d pos_init_;
   Eigen::Matrix<double, 3, 3> ori_init_;
@@ -139,21 +140,17 @@ class TorqueJointSpaceControllerSideChair : public controller_interface::MultiIn
   int contact_points_;
   int revolve_direction_;
 
-  std::vector<double> nx_;
-  std::vector<double> ny_;
-  std::vector<double> nz_;
-  std::vector<double> ex_;
-  std::vector<double> ey_;
-  std::vector<double> ez_;
-  std::vector<double> p_;
-
-  std::vector<double> mx_;
-  std::vector<double> my_;
-  std::vector<double> mz_;
-  std::vector<double> mx_ee_;
-  std::vector<double> my_ee_;
-  std::vector<double> mz_ee_;
-  std::vector<double> t_;
+  // contact normal n, end effector position e and plane offset p = n . e
+  // of every tick in contact since clearDirectionVector()
+  enum DirectionChannel { kNx, kNy, kNz, kEx, kEy, kEz, kP, kDirectionChannels };
+  SignalHistory<kDirectionChannels> direction_history_;
+
+  // latest moments in the base and ee frames, and the slope of the ee
+  // moments over the first and second half of a revolve motion
+  Eigen::Vector3d moment_;
+  Eigen::Vector3d moment_ee_;
+  SlopeEstimator moment_slope_[2][3];
+  double moment_split_time_;
 };
 
 static Eigen::Matrix<double, 6, 1> straightApproach(const Eigen::Vector3d origin,
@@ -403,49 +400,25 @@ static Eigen::Vector3d rotateWithGivenAxis(const Eigen::Vector3d rotation_axis,
 
 }
 
-static bool checkSideChairDone(const std::vector<double> v1,
-  const std::vector<double> v2,
-  const std::vector<double> v3,
-  const double threshold) //least square, y = ax + b
+// slopes[0] and [1] are the moment slopes of the first and second half of
+// a revolve. The contact is detected when their ratio stays within
+// threshold on more than one axis.
+static bool checkSideChairDone(const SlopeEstimator (&slopes)[2][3],
+  const double threshold)
 {
   bool is_done;
-  Eigen::MatrixXd x, y, z;
-  const int interval = 2;
-  const int member = 1; // how many component to be considered to get average value
   int count = 0;
-  double sum_x, sum_y, sum_z;
   Eigen::Vector3d avg;
   Eigen::Vector3d ratio;
   Eigen::Vector3d result; // 1 -> constraint motion / 0 -> free motion
 
-  x.resize(2,interval);
-  y.resize(2,interval);
-  z.resize(2,interval);
-
-  x.setZero();
-  y.setZero();
-  z.setZero();
   result.setZero();
-  ratio.setZero();
-
-  sum_x = 0.0;
-  sum_y = 0.0;
-  sum_z = 0.0;
-
-  x = DyrosMath::leastSquareLinear(v1,interval);
-  y = DyrosMath::leastSquareLinear(v2,interval);
-  z = DyrosMath::leastSquareLinear(v3,interval);
 
-  
-  for(int i = interval -1; i >= interval - member; i--)
+  for(int i = 0; i < 3; i++)
   {
-    sum_x += x(0,i);
-    sum_y += y(0,i);
-    sum_z += z(0,i);
+    avg(i) = slopes[1][i].slope();
+    ratio(i) = slopes[0][i].slope()/slopes[1][i].slope();
   }
-
-  avg << sum_x/member, sum_y/member, sum_z/member;
-  ratio << x(0,0)/x(0,1), y(0,0)/y(0,1), z(0,0)/z(0,1);
   ratio(2) = 0.0; //fix it later!!!! mutiple selection matrix!!!!
   
   for(int i = 0; i < 3; i++)
@@ -459,21 +432,12 @@ static bool checkSideChairDone(const std::vector<double> v1,
         count++;
       }
     }
-    // if(fabs(avg(i))<threshold) result(i) = 0.0;
-    // else
-    // {
-    //   result(i) = 1.0;
-    //   count++;
-    // } 
   }
 
   
   if(count > 1) is_done = true;
   else is_done = false;
 
-  // std::cout<<"mx slope: "<< x.block<1,interval>(0,0)<<std::endl;
-  // std::cout<<"my slope: "<< y.block<1,interval>(0,0)<<std::endl;
-  // std::cout<<"mz slope: "<< z.block<1,interval>(0,0)<<std::endl;
   std::cout<<"slope avg: "<<avg.transpose()<<std::endl;
   std::cout<<"result: "<<result.transpose()<<std::endl;
   std::cout<<"ratio: "<<ratio.transpose()<<std::endl;
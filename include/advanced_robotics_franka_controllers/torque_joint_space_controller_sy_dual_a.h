@@ -4,7 +4,8 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/spiral_generator.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -28,19 +29,13 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerSyDualA : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class TorqueJointSpaceControllerSyDualA : public TorqueControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
@@ -74,6 +69,7 @@ class TorqueJointSpaceControllerSyDualA : public controller_interface::MultiInte
   Eigen::Vector3d x_desired_;
   Eigen::Vector3d pos_first_state_, pos_return_state_;
   Eigen::Vector3d xdot_desired_;
+  SpiralGenerator spiral_;
   Eigen::Vector3d spiral_origin_;
   Eigen::Vector3d spiral_done_pos_;
   Eigen::Vector3d spiral_fail_check_step_;
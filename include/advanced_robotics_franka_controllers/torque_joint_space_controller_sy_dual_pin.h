@@ -4,7 +4,9 @@
 #include <string>
 #include <vector>
 
-#include <controller_interface/multi_interface_controller.h>
+#include <advanced_robotics_franka_controllers/franka_controller_base.h>
+#include <advanced_robotics_franka_controllers/spiral_generator.h>
+#include <advanced_robotics_franka_controllers/telemetry_recorder.h>
 #include <dynamic_reconfigure/server.h>
 #include <franka_hw/franka_model_interface.h>
 #include <franka_hw/franka_state_interface.h>
@@ -28,19 +30,13 @@
 
 namespace advanced_robotics_franka_controllers {
 
-class TorqueJointSpaceControllerSyDualPin : public controller_interface::MultiInterfaceController<
-								   franka_hw::FrankaModelInterface,
-								   hardware_interface::EffortJointInterface,
-								   franka_hw::FrankaStateInterface> {
+class TorqueJointSpaceControllerSyDualPin : public TorqueControllerBase {
                      
-  bool init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
+  bool initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle) override;
   void starting(const ros::Time& time) override;
-  void update(const ros::Time& time, const ros::Duration& period) override;
+  void updateController(const ros::Time& time, const ros::Duration& period) override;
 
  private: 
-  std::unique_ptr<franka_hw::FrankaModelHandle> model_handle_;
-  std::unique_ptr<franka_hw::FrankaStateHandle> state_handle_;
-  std::vector<hardware_interface::JointHandle> joint_handles_;
 
 
   //std::unique_ptr<franka_gripper::grasp> gripper_;
@@ -65,19 +61,20 @@ class TorqueJointSpaceControllerSyDualPin : public controller_interface::MultiIn
   Eigen::Matrix<double, 3, 3> ori_first_state_, ori_return_state_;
 
 
-  FILE *joint0_data;
-  FILE *save_data_x;
-  FILE *save_data_x2;
-  FILE *save_data_x3;
-  FILE *reaction_force;
-  FILE *save_cmd;
-  FILE *save_fm;
-  FILE *gain_tunning;
+  TelemetryRecorder telemetry_;
+  int theta_channel_;
+  int torque_channel_;
+  int position_channel_;
+  int time_channel_;
+  int cmd_channel_;
+  int force_moment_channel_;
+  int gain_tunning_channel_;
 
   Eigen::Vector3d target_x_;
   Eigen::Vector3d x_desired_;
   Eigen::Vector3d pos_first_state_, pos_return_state_;
   Eigen::Vector3d xdot_desired_;
+  SpiralGenerator spiral_;
   Eigen::Vector3d spiral_origin_;
   Eigen::Vector3d spiral_done_pos_;
   Eigen::Vector3d spiral_fail_check_step_;
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace advanced_robotics_franka_controllers {
+
+struct TrajectoryPoint
+{
+  double position;
+  double velocity;
+  double acceleration;
+};
+
+// x(t) = sum_k c_k (t - t0)^k on [t0, tf]. The coefficients are solved once
+// at construction; evaluate() is one Horner pass each for position, velocity
+// and acceleration. Outside [t0, tf] the boundary conditions are returned,
+// like DyrosMath::cubic/cubicDot/QuinticSpline.
+//
+//   starting(): segment_ = CubicSegment(t0, t0 + 3.0, q0, q_goal, 0.0, 0.0);
+//   update():   const TrajectoryPoint p = segment_.evaluate(time.toSec());
+template <int Degree>
+class PolynomialSegment
+{
+ public:
+  TrajectoryPoint evaluate(double time) const
+  {
+    if (time <= time_0_)
+      return start_;
+    if (time >= time_f_)
+      return end_;
+
+    const double t = time - time_0_;
+    TrajectoryPoint point{c_[Degree], dc_[Degree - 1], ddc_[Degree - 2]};
+    for (int k = Degree - 1; k >= 0; --k)
+      point.position = point.position * t + c_[k];
+    for (int k = Degree - 2; k >= 0; --k)
+      point.velocity = point.velocity * t + dc_[k];
+    for (int k = Degree - 3; k >= 0; --k)
+      point.acceleration = point.acceleration * t + ddc_[k];
+    return point;
+  }
+
+  double startTime() const { return time_0_; }
+  double endTime() const { return time_f_; }
+
+ protected:
+  PolynomialSegment() = default;
+
+  void set(double time_0, double time_f, const TrajectoryPoint &start, const TrajectoryPoint &end,
+           const double (&c)[Degree + 1])
+  {
+    time_0_ = time_0;
+    time_f_ = time_f;
+    start_ = start;
+    end_ = end;
+    for (int k = 0; k <= Degree; ++k)
+      c_[k] = c[k];
+    for (int k = 0; k < Degree; ++k)
+      dc_[k] = (k + 1) * c[k + 1];
+    for (int k = 0; k < Degree - 1; ++k)
+      ddc_[k] = (k + 2) * (k + 1) * c[k + 2];
+  }
+
+ private:
+  double time_0_{0.0};
+  double time_f_{0.0};
+  TrajectoryPoint start_{0.0, 0.0, 0.0};
+  TrajectoryPoint end_{0.0, 0.0, 0.0};
+  double c_[Degree + 1]{};
+  double dc_[Degree]{};
+  double ddc_[Degree - 1]{};
+};
+
+// position and velocity boundary conditions
+class CubicSegment : public PolynomialSegment<3>
+{
+ public:
+  CubicSegment() = default;
+  CubicSegment(double time_0, double time_f, double x_0, double x_f, double x_dot_0, double x_dot_f)
+  {
+    const double T = time_f - time_0;
+    double c[4] = {x_0, x_dot_0, 0.0, 0.0};
+    if (T > 0.0)
+    {
+      const double h = x_f - x_0;
+      c[2] = (3.0 * h / T - 2.0 * x_dot_0 - x_dot_f) / T;
+      c[3] = (-2.0 * h / T + x_dot_0 + x_dot_f) / (T * T);
+    }
+    set(time_0, time_f, {x_0, x_dot_0, 0.0}, {x_f, x_dot_f, 0.0}, c);
+  }
+};
+
+// position, velocity and acceleration boundary conditions, in closed form
+class QuinticSegment : public PolynomialSegment<5>
+{
+ public:
+  QuinticSegment() = default;
+  QuinticSegment(double time_0, double time_f, double x_0, double x_dot_0, double x_ddot_0, double x_f,
+                 double x_dot_f, double x_ddot_f)
+  {
+    const double T = time_f - time_0;
+    double c[6] = {x_0, x_dot_0, 0.5 * x_ddot_0, 0.0, 0.0, 0.0};
+    if (T > 0.0)
+    {
+      const double h = x_f - x_0;
+      const double T2 = T * T;
+      c[3] = (20.0 * h - (8.0 * x_dot_f + 12.0 * x_dot_0) * T - (3.0 * x_ddot_0 - x_ddot_f) * T2) / (2.0 * T2 * T);
+      c[4] = (-30.0 * h + (14.0 * x_dot_f + 16.0 * x_dot_0) * T + (3.0 * x_ddot_0 - 2.0 * x_ddot_f) * T2) /
+             (2.0 * T2 * T2);
+      c[5] = (12.0 * h - 6.0 * (x_dot_f + x_dot_0) * T - (x_ddot_0 - x_ddot_f) * T2) / (2.0 * T2 * T2 * T);
+    }
+    set(time_0, time_f, {x_0, x_dot_0, x_ddot_0}, {x_f, x_dot_f, x_ddot_f}, c);
+  }
+};
+
+// rest to rest minimum jerk, x_0 + (x_f - x_0) (10 s^3 - 15 s^4 + 6 s^5)
+class MinJerkSegment : public QuinticSegment
+{
+ public:
+  MinJerkSegment() = default;
+  MinJerkSegment(double time_0, double time_f, double x_0, double x_f)
+    : QuinticSegment(time_0, time_f, x_0, 0.0, 0.0, x_f, 0.0, 0.0)
+  {
+  }
+};
+
+template <int N>
+struct MultiTrajectoryPoint
+{
+  Eigen::Matrix<double, N, 1> position;
+  Eigen::Matrix<double, N, 1> velocity;
+  Eigen::Matrix<double, N, 1> acceleration;
+};
+
+// N channels (e.g. the 7 joints) that share t0 and tf, evaluated together.
+// Each coefficient is stored as one array over the channels (structure of
+// arrays), padded to a multiple of 4 lanes, so a Horner step is one
+// multiply-add per SIMD packet for all joints instead of one scalar call
+// per joint. Construction costs about as much as the scalar loop, so build
+// the segment once per motion, not every tick.
+//
+//   starting(): homing_ = MultiCubicSegment<7>(t0, t0 + 3.0, q_init_, q_goal);
+//   update():   const MultiTrajectoryPoint<7> desired = homing_.evaluate(time.toSec());
+template <int N, int Degree>
+class MultiPolynomialSegment
+{
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  typedef Eigen::Matrix<double, N, 1> Vector;
+
+  MultiTrajectoryPoint<N> evaluate(double time) const
+  {
+    if (time <= time_0_)
+      return start_;
+    if (time >= time_f_)
+      return end_;
+
+    const double t = time - time_0_;
+    Lanes position = c_[Degree];
+    Lanes velocity = dc_[Degree - 1];
+    Lanes acceleration = ddc_[Degree - 2];
+    for (int k = Degree - 1; k >= 0; --k)
+      position = position * t + c_[k];
+    for (int k = Degree - 2; k >= 0; --k)
+      velocity = velocity * t + dc_[k];
+    for (int k = Degree - 3; k >= 0; --k)
+      acceleration = acceleration * t + ddc_[k];
+
+    MultiTrajectoryPoint<N> point;
+    point.position = position.template head<N>();
+    point.velocity = velocity.template head<N>();
+    point.acceleration = acceleration.template head<N>();
+    return point;
+  }
+
+  double startTime() const { return time_0_; }
+  double endTime() const { return time_f_; }
+
+ protected:
+  static constexpr int kLanes = (N + 3) / 4 * 4;
+  typedef Eigen::Array<double, kLanes, 1> Lanes;
+
+  MultiPolynomialSegment()
+  {
+    for (auto &c : c_)
+      c.setZero();
+    finish();
+    start_.position.setZero();
+    start_.velocity.setZero();
+    start_.acceleration.setZero();
+    end_ = start_;
+  }
+  // the derived constructors fill in everything
+  MultiPolynomialSegment(double time_0, double time_f) : time_0_(time_0), time_f_(time_f) {}
+
+  // c_k already filled in; derives the velocity and acceleration coefficients
+  void finish()
+  {
+    for (int k = 0; k < Degree; ++k)
+      dc_[k] = (k + 1) * c_[k + 1];
+    for (int k = 0; k < Degree - 1; ++k)
+      ddc_[k] = ((k + 2) * (k + 1)) * c_[k + 2];
+  }
+
+  static Lanes lanes(const Vector &v)
+  {
+    Lanes l;
+    l.template head<N>() = v.array();
+    l.template tail<kLanes - N>().setZero();
+    return l;
+  }
+
+  double time_0_{0.0};
+  double time_f_{0.0};
+  MultiTrajectoryPoint<N> start_;
+  MultiTrajectoryPoint<N> end_;
+  Lanes c_[Degree + 1];
+  Lanes dc_[Degree];
+  Lanes ddc_[Degree - 1];
+};
+
+template <int N>
+class MultiCubicSegment : public MultiPolynomialSegment<N, 3>
+{
+  typedef MultiPolynomialSegment<N, 3> Base;
+
+ public:
+  typedef typename Base::Vector Vector;
+
+  MultiCubicSegment() = default;
+  MultiCubicSegment(double time_0, double time_f, const Vector &x_0, const Vector &x_f)
+    : MultiCubicSegment(time_0, time_f, x_0, x_f, Vector::Zero(), Vector::Zero())
+  {
+  }
+  MultiCubicSegment(double time_0, double time_f, const Vector &x_0, const Vector &x_f, const Vector &x_dot_0,
+                    const Vector &x_dot_f)
+    : Base(time_0, time_f)
+  {
+    this->start_.position = x_0;
+    this->start_.velocity = x_dot_0;
+    this->start_.acceleration.setZero();
+    this->end_.position = x_f;
+    this->end_.velocity = x_dot_f;
+    this->end_.acceleration.setZero();
+
+    const double T = time_f - time_0;
+    const double T_inv = T > 0.0 ? 1.0 / T : 0.0;
+    const typename Base::Lanes h = Base::lanes(x_f - x_0);
+    const typename Base::Lanes v_0 = Base::lanes(x_dot_0);
+    const typename Base::Lanes v_f = Base::lanes(x_dot_f);
+    this->c_[0] = Base::lanes(x_0);
+    this->c_[1] = v_0;
+    this->c_[2] = (3.0 * T_inv * h - 2.0 * v_0 - v_f) * T_inv;
+    this->c_[3] = (-2.0 * T_inv * h + v_0 + v_f) * (T_inv * T_inv);
+    this->finish();
+  }
+};
+
+template <int N>
+class MultiQuinticSegment : public MultiPolynomialSegment<N, 5>
+{
+  typedef MultiPolynomialSegment<N, 5> Base;
+
+ public:
+  typedef typename Base::Vector Vector;
+
+  MultiQuinticSegment() = default;
+  MultiQuinticSegment(double time_0, double time_f, const Vector &x_0, const Vector &x_dot_0, const Vector &x_ddot_0,
+                      const Vector &x_f, const Vector &x_dot_f, const Vector &x_ddot_f)
+    : Base(time_0, time_f)
+  {
+    this->start_ = {x_0, x_dot_0, x_ddot_0};
+    this->end_ = {x_f, x_dot_f, x_ddot_f};
+
+    const double T = time_f - time_0;
+    this->c_[0] = Base::lanes(x_0);
+    this->c_[1] = Base::lanes(x_dot_0);
+    this->c_[2] = 0.5 * Base::lanes(x_ddot_0);
+    if (T > 0.0)
+    {
+      const typename Base::Lanes h = Base::lanes(x_f - x_0);
+      const typename Base::Lanes v_0 = this->c_[1];
+      const typename Base::Lanes v_f = Base::lanes(x_dot_f);
+      const typename Base::Lanes a_0 = Base::lanes(x_ddot_0);
+      const typename Base::Lanes a_f = Base::lanes(x_ddot_f);
+      const double T2 = T * T;
+      this->c_[3] = (20.0 * h - (8.0 * v_f + 12.0 * v_0) * T - (3.0 * a_0 - a_f) * T2) / (2.0 * T2 * T);
+      this->c_[4] = (-30.0 * h + (14.0 * v_f + 16.0 * v_0) * T + (3.0 * a_0 - 2.0 * a_f) * T2) / (2.0 * T2 * T2);
+      this->c_[5] = (12.0 * h - 6.0 * (v_f + v_0) * T - (a_0 - a_f) * T2) / (2.0 * T2 * T2 * T);
+    }
+    else
+    {
+      this->c_[3].setZero();
+      this->c_[4].setZero();
+      this->c_[5].setZero();
+    }
+    this->finish();
+  }
+};
+
+}  // namespace advanced_robotics_franka_controllers
@@ -20,11 +20,22 @@
 
 namespace CrispLogic
 {
-    static int velocityInputCrisp(const double z_vel)
+    // Thresholds between the crisp input classes; crispLogic() uses the
+    // tuned kContactStateThresholds, a parameter sweep passes its own.
+    struct ContactStateThresholds
+    {
+        double velocity;
+        double displacement[4];
+        double force[2];
+    };
+
+    static constexpr ContactStateThresholds kContactStateThresholds{0.0065, {0.0005, 0.003, 0.005, 0.01}, {6.2, 20.6667}};
+
+    static int velocityInputCrisp(const double z_vel, const ContactStateThresholds &thresholds = kContactStateThresholds)
     {
         int result = 0;
         double v;
-        v = 0.0065;
+        v = thresholds.velocity;
 
         if(z_vel <= v)
         {
@@ -39,13 +50,14 @@ namespace CrispLogic
         
     }
 
-     static int displacementInputCrisp(const double origin, const double z_dis)
+     static int displacementInputCrisp(const double origin, const double z_dis,
+                                       const ContactStateThresholds &thresholds = kContactStateThresholds)
     {
         double z_pvs, z_ps, z_pm, z_pb;
-        z_pvs = 0.0005;
-        z_ps = 0.003;
-        z_pm = 0.005;
-        z_pb = 0.01;
+        z_pvs = thresholds.displacement[0];
+        z_ps = thresholds.displacement[1];
+        z_pm = thresholds.displacement[2];
+        z_pb = thresholds.displacement[3];
 
         int result = 0;
         double dis;
@@ -62,12 +74,12 @@ namespace CrispLogic
     }
 
     
-    static int forceInputCrisp(const double force)
+    static int forceInputCrisp(const double force, const ContactStateThresholds &thresholds = kContactStateThresholds)
     {
      
         double f_ps, f_pm;
-        f_ps = 6.2;
-        f_pm = 20.6667;
+        f_ps = thresholds.force[0];
+        f_pm = thresholds.force[1];
 
 
         int result;
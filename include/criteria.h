@@ -6,6 +6,8 @@
 #include <unsupported/Eigen/MatrixFunctions>
 #include <cmath>
 
+#include <advanced_robotics_franka_controllers/running_statistics.h>
+
 #include "math_type_define.h"
 #include "fuzzycontrol.h"
 #include "crispcontrol.h"
@@ -165,24 +167,15 @@ namespace Criteria
         return is_done;
     }
 
-    static bool checkForceDot(const std::vector<double> vec, const double threshold)
+    // |last - previous| of the force history
+    template <int N>
+    static bool checkForceDot(const advanced_robotics_franka_controllers::RunningStatistics<N> &force,
+        const double threshold)
     {
         bool is_done;
-        double f1,f2;
         double del_f;
-        std::vector<double> force;
-
-        force = vec;
-
-        if(vec.size() < 2) del_f = 0.0;
-        else
-        {
-            f1 = force.back();
-            force.pop_back();
-            f2 = force.back();
 
-            del_f = abs(f2 - f1);
-        }          
+        del_f = fabs(force.difference());
 
         if(del_f >= threshold) is_done = true;
         else is_done = false;
@@ -190,39 +183,25 @@ namespace Criteria
         return is_done;
     }
 
-    static bool checkMomentLimit(const std::vector<double> m1,
-        const std::vector<double> m2,
-        const std::vector<double> m3,
+    // mean of |m| over the window of the swing axis (1, 2 or 3)
+    template <int N>
+    static bool checkMomentLimit(const advanced_robotics_franka_controllers::RunningStatistics<N> &m1,
+        const advanced_robotics_franka_controllers::RunningStatistics<N> &m2,
+        const advanced_robotics_franka_controllers::RunningStatistics<N> &m3,
         const int swing_dir,
         const double threshold)        
     {   
         bool is_done;
-        int size;
-        double sum;
-        double avg;
-        
-        std::vector<double> m;
-
-        if(swing_dir == 1) m = m1;
-        if(swing_dir == 2) m = m2;
-        if(swing_dir == 3) m = m3;
-
-        size = int(m.size());
+        double avg = 0.0;
 
-        for(int i = 0; i < size; i ++)
-        {
-            sum += fabs(double(m[i]));
-        }
-        
-        avg = sum / size;
+        if(swing_dir == 1) avg = m1.absMean();
+        if(swing_dir == 2) avg = m2.absMean();
+        if(swing_dir == 3) avg = m3.absMean();
 
         if(avg >= threshold) is_done = true;
         else is_done = false;
 
-        // std::cout<<"size : "<<size<<std::endl;
-        // std::cout<<"sum : "<<sum<<std::endl;
         std::cout<<"moment avg : "<<avg<<std::endl;
-        // std::cout<<"is_done : "<<is_done<<std::endl;
         
         return is_done;
     }
@@ -244,24 +223,14 @@ namespace Criteria
     //     return is_done;
     // }
     
-    static double fuzzyLogic(const double origin, const double vel, const double dis, const double force)
+    static double fuzzyLogic(const double origin, const double vel, const double dis, const double force,
+                             const ContactStateClassifier &classifier = kContactStateClassifier)
     {
-        Eigen::Vector2d v;
-        Eigen::Matrix<double, 5, 1> z;
-        Eigen::Vector3d f;
-
-        double u;
-        
-        v = velocityInput(vel);        
-        z = displacementInput(origin, dis);        
-        f = forceInput(force);      
-        
-        u = fuzzyOutput(v,z,f);
-        // std::cout<<"---------------------------------------"<<std::endl;
-        return u;
+        return classifier.classify(origin, vel, dis, force);
     }
 
-    static int crispLogic(const double origin, const double vel, const double dis, const double force)
+    static int crispLogic(const double origin, const double vel, const double dis, const double force,
+                          const ContactStateThresholds &thresholds = kContactStateThresholds)
     {
         int v;
         int z;
@@ -269,9 +238,9 @@ namespace Criteria
 
         int u;
         
-        v = velocityInputCrisp(vel);        
-        z = displacementInputCrisp(origin, dis);        
-        f = forceInputCrisp(force);      
+        v = velocityInputCrisp(vel, thresholds);        
+        z = displacementInputCrisp(origin, dis, thresholds);        
+        f = forceInputCrisp(force, thresholds);      
         
         u = crispOutput(v,z,f);
         // std::cout<<"---------------------------------------"<<std::endl;
@@ -5,6 +5,8 @@
 #include <unsupported/Eigen/MatrixFunctions>
 #include <cmath>
 
+#include <advanced_robotics_franka_controllers/fuzzy_inference.h>
+
 // #define MOVE 0.5
 // #define DEAD 0.0
 // #define HOLE 1.0
@@ -20,48 +22,78 @@
 
 namespace FuzzyLogic
 {
-    static Eigen::Vector2d velocityInput(const double z_vel)
-    {
-        //parameters fuzzy-logic-velocity function
-        //--------------------
-        double v_s = 0.006;
-        double v_s_end = 0.007;
-        //--------------------
-        double v_b_start = 0.006;
-        double v_b = 0.007;
-        //--------------------
-        double vel;
-        
+    using advanced_robotics_franka_controllers::FuzzyRuleBase;
+    using advanced_robotics_franka_controllers::MembershipTable;
 
-        Eigen::Vector2d result;
-        result.setZero();
+    // Breakpoints of the membership functions of the three inputs, see
+    // rampMembershipTable(), and the contact state each rule concludes.
 
-        vel = -z_vel;
-        // vel = z_vel;
+    // velocity -z_vel: small, big
+    static constexpr double kVelocityBreakpoints[3] = {0.006, 0.007, 0.007};
 
-        // vel = 0.0069; //debug
-        // vel = -0.0022;
+    // displacement origin - z_dis: very small (move), small (fake),
+    // medium (shallow dead), big (hole), very big (deep dead)
+    static constexpr double kDisplacementBreakpoints[9] = {0.0005, 0.00175, 0.003, 0.004, 0.005,
+                                                           0.0075, 0.01, 0.012, 0.013};
 
-        if(vel <= v_s)
-        {
-            result(0) = 1;
-            result(1) = 0;
-        }
-            
-        else if( v_s < vel && vel <= v_s_end)
-        {
-            result(0) = fabs(1/(v_s_end-v_s)*(vel - v_s_end));
-            result(1) = 1/(v_b-v_b_start)*(vel - v_b_start);
-        }
-            
-        else
+    // force: small, medium, big
+    static constexpr double kForceBreakpoints[5] = {2.0, 8.0, 16.0, 23.0, 30.0};
+
+    // rule 15 v + 3 z + f
+    static constexpr double kContactStateRules[30] = {
+        CS_ONE, CS_TWO, CS_TWO, CS_ONE, CS_TWO, CS_THREE, CS_FIVE_ONE, CS_FIVE_ONE, CS_FOUR, CS_FOUR, CS_FOUR, CS_FOUR, CS_FIVE_TWO, CS_FIVE_TWO, CS_FIVE_TWO,
+        NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, CS_FIVE_TWO, CS_FIVE_TWO, CS_FIVE_TWO};
+
+    // the contact state within 0.2 of u, otherwise u itself
+    static double snapContactState(const double u)
+    {
+        const double nearest = std::round(u);
+        if(nearest >= NONE && nearest <= CS_FIVE_TWO && fabs(u - nearest) <= 0.2) return nearest;
+        return u;
+    }
+
+    // Fuzzy contact state classifier. fuzzyLogic() uses the tuned
+    // kContactStateClassifier; a parameter sweep builds its own from
+    // candidate breakpoints with contactStateClassifier(). classify()
+    // allocates nothing and prints nothing.
+    struct ContactStateClassifier
+    {
+        MembershipTable<2, 3> velocity;
+        MembershipTable<5, 9> displacement;
+        MembershipTable<3, 5> force;
+        FuzzyRuleBase<2, 5, 3> rules;
+
+        double classify(const double origin, const double z_vel, const double z_dis, const double f) const
         {
-            result(0) = 0;
-            result(1) = 1;
+            double v_membership[2];
+            double z_membership[5];
+            double f_membership[3];
+            velocity.evaluate(-z_vel, v_membership);
+            displacement.evaluate(origin - z_dis, z_membership);
+            force.evaluate(f, f_membership);
+            return snapContactState(rules.infer({{v_membership, z_membership, f_membership}}));
         }
-        // std::cout<<"vel: "<<vel<<std::endl;
-        // std::cout<<"vel_input:"<<result.transpose()<<std::endl;
-        // std::cout<<"Fuzzifed velocity: "<<result.transpose()<<std::endl;
+    };
+
+    static constexpr ContactStateClassifier contactStateClassifier(const double (&velocity)[3],
+                                                                   const double (&displacement)[9],
+                                                                   const double (&force)[5])
+    {
+        return ContactStateClassifier{advanced_robotics_franka_controllers::rampMembershipTable<2>(velocity),
+                                      advanced_robotics_franka_controllers::rampMembershipTable<5>(displacement),
+                                      advanced_robotics_franka_controllers::rampMembershipTable<3>(force),
+                                      FuzzyRuleBase<2, 5, 3>(kContactStateRules)};
+    }
+
+    static constexpr ContactStateClassifier kContactStateClassifier =
+        contactStateClassifier(kVelocityBreakpoints, kDisplacementBreakpoints, kForceBreakpoints);
+
+    static Eigen::Vector2d velocityInput(const double z_vel)
+    {
+        Eigen::Vector2d result;
+        double membership[2];
+        kContactStateClassifier.velocity.evaluate(-z_vel, membership);
+        result << membership[0], membership[1];
         return result;
     }
 
@@ -183,128 +215,10 @@ namespace FuzzyLogic
     // }
      static Eigen::Matrix<double, 5, 1> displacementInput(const double origin, const double z_dis)
     {
-        //parameters fuzzy-logic-displacement function
-        //--------------------
-        double z_pvs = 0.0005;
-        double z_pvs_end = 0.00175;
-        //--------------------
-        
-        double z_ps = 0.003;
-        double z_ps_end = 0.004;
-        //--------------------
-        
-        double z_pm = 0.005;
-        double z_pm_end = 0.0075;
-        //--------------------
-
-        double z_pb = 0.01;
-        double z_pb_end = 0.012;
-        //--------------------
-        
-        double z_pvb = 0.013;
-        
-        double dis;
-        // std::cout<<"spiral orign: "<<origin<<std::endl;
         Eigen::Matrix<double, 5, 1> result;
-        result.setZero();
-
-        dis = origin - z_dis;
-        
-        // dis = 0.0044; //debug
-        // dis = 0.0059;
-        if( dis <= z_pvs)
-        {
-            result(0) = 1; // move
-            result(1) = 0; // fake
-            result(2) = 0; // shallow dead
-            result(3) = 0; // hole
-            result(4) = 0; // deep dead
-        }
-            
-        else if( z_pvs < dis && dis <= z_pvs_end)
-        {
-            result(0) = fabs(1/(z_pvs_end - z_pvs)*(dis - z_pvs_end));
-            result(1) = 1/(z_ps - z_pvs)*(dis - z_pvs);
-            result(2) = 0;
-            result(3) = 0;
-            result(4) = 0;
-        }
-            
-        else if( z_pvs_end < dis && dis <= z_ps)
-        {
-            result(0) = 0;
-            result(1) = 1/(z_ps - z_pvs)*(dis - z_pvs);;
-            result(2) = 0;
-            result(3) = 0;
-            result(4) = 0;
-        }
-            
-        else if( z_ps < dis && dis <= z_ps_end)
-        {
-            result(0) = 0;
-            result(1) = fabs(1/(z_ps_end - z_ps)*(dis - z_ps_end));
-            result(2) = 1/(z_pm - z_ps)*(dis - z_ps);
-            result(3) = 0;
-            result(4) = 0;
-        }
-            
-        else if( z_ps_end < dis && dis <= z_pm)
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 1/(z_pm - z_ps)*(dis - z_ps);
-            result(3) = 0;
-            result(4) = 0;
-        }
-            
-        else if( z_pm < dis && dis <= z_pm_end)
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = fabs(1/(z_pm_end - z_pm)*(dis - z_pm_end));
-            result(3) = 1/(z_pb - z_pm)*(dis - z_pm);
-            result(4) = 0;
-        }
-            
-        else if( z_pm_end < dis && dis <= z_pb)
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 0;
-            result(3) = 1/(z_pb - z_pm)*(dis - z_pm);
-            result(4) = 0;
-        }
-            
-        else if( z_pb < dis && dis <= z_pb_end)
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 0;
-            result(3) = fabs(1/(z_pb_end - z_pb)*(dis - z_pb_end));
-            result(4) = 1/(z_pvb - z_pb)*(dis - z_pb);       
-        }
-        
-        else if( z_pb_end < dis && dis <= z_pvb)
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 0;
-            result(3) = 0;
-            result(4) = 1/(z_pvb - z_pb)*(dis - z_pb);     
-        }
-
-        else
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 0;
-            result(3) = 0;
-            result(4) = 1;
-        }
-        
-        // std::cout<<"dis_input:"<<result.transpose()<<std::endl;
-
-        // std::cout<<"fuzzified displacement: "<<result.transpose()<<std::endl;
+        double membership[5];
+        kContactStateClassifier.displacement.evaluate(origin - z_dis, membership);
+        result << membership[0], membership[1], membership[2], membership[3], membership[4];
         return result;
     }
 
@@ -368,155 +282,16 @@ namespace FuzzyLogic
 
     static Eigen::Vector3d forceInput(const double force)
     {
-        //parameters fuzzy-logic-force function
-        //--------------------
-        double f_ps = 2.0;
-        double f_ps_end = 8.0;
-        //--------------------
-        
-        double f_pm = 16.0;
-        double f_pm_end = 23.0;
-        //--------------------
-        
-        double f_pb = 30.0;
-        //--------------------
-
-        double f = force;
-
         Eigen::Vector3d result;
-        result.setZero();
-
-        // f = 1.4217; //debug
-        // f = 0.6447;
-        if( f <= f_ps)
-        {
-            result(0) = 1;
-            result(1) = 0;
-            result(2) = 0;
-        }
-            
-        else if( f_ps < f && f <= f_ps_end)
-        {
-            result(0) = fabs(1/(f_ps_end-f_ps)*(f - f_ps_end));
-            result(1) = 1/(f_pm-f_ps)*(f - f_ps);
-            result(2) = 0;
-        }
-            
-        else if( f_ps_end < f && f <= f_pm)
-        {
-            result(0) = 0;
-            result(1) = 1/(f_pm-f_ps)*(f - f_ps);
-            result(2) = 0;    
-        }
-            
-        else if( f_pm < f && f <= f_pm_end)
-        {
-            result(0) = 0;
-            result(1) = fabs(1/(f_pm_end - f_pm)*(f - f_pm_end));
-            result(2) = 1/(f_pb - f_pm)*(f - f_pm);
-        }
-
-        else if( f_pm_end < f && f <= f_pb)
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 1/(f_pb - f_pm)*(f - f_pm);
-        }
-            
-        else
-        {
-            result(0) = 0;
-            result(1) = 0;
-            result(2) = 1;    
-        }
-        
-        // std::cout<<"force_input:"<<result.transpose()<<std::endl;
-
-        // std::cout<<"Fuzzified force: "<<result.transpose()<<std::endl;
+        double membership[3];
+        kContactStateClassifier.force.evaluate(force, membership);
+        result << membership[0], membership[1], membership[2];
         return result;
     }
 
-    static double andOperator(const double x, const double y, const double z)
-    {   
-        double result;
-
-        if( x <= y)
-        {
-            if(x <= z)  result = x;
-            else    result = z;
-        }            
-            
-        else
-        {
-            if(y <= z)  result = y;
-            else    result = z;
-        }
-         
-        return result;     
-    }
-    
-    
     static double fuzzyOutput(const Eigen::Vector2d v, const Eigen::Matrix<double, 5, 1> z, const Eigen::Vector3d f)
     {
-        int v_size = 2;
-        int z_size = 5;
-        int f_size = 3;
-
-        double num = 0.0;
-        double den = 0.0;
-        double acceptable = 0.2;
-        
-        double result; 
-
-        Eigen::MatrixXd output_set;
-        Eigen::MatrixXd state_set;
-
-        output_set.resize(v_size*z_size*f_size,1);
-        output_set.setZero();
-
-        state_set.resize(v_size*z_size*f_size,1);
-        output_set.setZero();
-        
-        // state_set << MOVE, MOVE, HOLE, MOVE, MOVE, FAKE, DEAD, HOLE, HOLE, HOLE, HOLE, HOLE, DEAD, DEAD, DEAD,
-        //                 MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, MOVE, DEAD, DEAD, DEAD;
-        state_set << CS_ONE, CS_TWO, CS_TWO, CS_ONE, CS_TWO, CS_THREE, CS_FIVE_ONE, CS_FIVE_ONE, CS_FOUR, CS_FOUR, CS_FOUR, CS_FOUR, CS_FIVE_TWO, CS_FIVE_TWO, CS_FIVE_TWO,
-                        NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, CS_FIVE_TWO, CS_FIVE_TWO, CS_FIVE_TWO;
-                            
-        for(int k = 0; k < v_size; k++)
-        {
-            for(int i = 0; i < z_size; i++)
-            {
-                for(int j = 0; j < f_size; j++)
-                {
-                    output_set((z_size*f_size*(k)+f_size*(i)+j)) = andOperator(v(k),z(i),f(j));
-                }                     
-            }                 
-        }
-
-        for(int i = 0; i < z_size*f_size*v_size; i ++)
-        {
-            // if(state_set(i) != NONE)
-            // {
-                num = num + state_set(i)*output_set(i);   
-                den = den + output_set(i);
-                // if(den == 0)    result = 0;
-                // else result = num/den;
-                result = num/den;
-            // }
-        }
-
-        if(fabs(result - NONE) <= acceptable)   result = NONE;
-        else if(fabs(result - CS_ONE) <= acceptable)  result = CS_ONE;
-        else if(fabs(result - CS_TWO) <= acceptable)  result = CS_TWO;
-        else if(fabs(result - CS_THREE) <= acceptable)  result = CS_THREE;
-        else if(fabs(result - CS_FOUR) <= acceptable)  result = CS_FOUR;
-        else if(fabs(result - CS_FIVE_ONE) <= acceptable)  result = CS_FIVE_ONE;
-        else if(fabs(result - CS_FIVE_TWO) <= acceptable)  result = CS_FIVE_TWO;
-        else result = result;
-
-        std::cout<<"result: "<<result<<std::endl;
-        return result;
-        
+        return snapContactState(kContactStateClassifier.rules.infer({{v.data(), z.data(), f.data()}}));
     }
 
 
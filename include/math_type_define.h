@@ -9,6 +9,10 @@
 #include <Eigen/Dense>
 #include <unsupported/Eigen/MatrixFunctions>
 #include <fstream>
+#include <iostream>
+
+#include <advanced_robotics_franka_controllers/discrete_riccati.h>
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
 
 #define GRAVITY 9.80665
 #define MAX_DOF 50U
@@ -757,116 +761,19 @@ static void floatGyroframe(Eigen::Isometry3d trunk, Eigen::Isometry3d reference,
   new_trunk.translation() = temp*(trunk.translation() - reference.translation());
 }
 
+// X = A^T X A - A^T X B (R + B^T X B)^-1 B^T X A + Q, see
+// advanced_robotics_franka_controllers::solveDiscreteRiccati for the fixed
+// size version. Returns an empty matrix if the iteration did not converge
+// (e.g. (A, B) not stabilizable), check x.size() before using the gains.
 static Eigen::MatrixXd discreteRiccatiEquation(Eigen::MatrixXd a, Eigen::MatrixXd b, Eigen::MatrixXd r, Eigen::MatrixXd q)
 {
-  int n=a.rows(); //number of rows
-  int	m=b.cols(); //number of columns
-
-  Eigen::MatrixXd z11(n, n), z12(n, n), z21(n, n), z22(n, n);
-
-  z11 = a.inverse();
-  z12 = a.inverse()*b*r.inverse()*b.transpose();
-  z21 = q*a.inverse();
-  z22 = a.transpose() + q*a.inverse()*b*r.inverse()*b.transpose();
-
-  Eigen::MatrixXd z; z.resize(2*n, 2*n);
-  z.setZero();
-  z.topLeftCorner(n,n) = z11;
-  z.topRightCorner(n,n) = z12;
-  z.bottomLeftCorner(n,n) = z21;
-  z.bottomRightCorner(n,n) = z22;
-
-
-  std::vector<Eigen::VectorXd> eigVec_real(2*n);
-  std::vector<Eigen::VectorXd> eigVec_img(2*n);
-
-  for(int i=0; i<8; i++)
-  {
-    eigVec_real[i].resize(2*n);
-    eigVec_real[i].setZero();
-    eigVec_img[i].resize(2*n);
-    eigVec_img[i].setZero();
-  }
-
-  Eigen::VectorXd deigVal_real(2*n);
-  Eigen::VectorXd deigVal_img(2*n);
-  deigVal_real.setZero();
-  deigVal_img.setZero();
-  Eigen::MatrixXd deigVec_real(2*n,2*n);
-  Eigen::MatrixXd deigVec_img(2*n,2*n);
-  deigVec_real.setZero();
-  deigVec_img.setZero();
-
-  deigVal_real = z.eigenvalues().real();
-  deigVal_img = z.eigenvalues().imag();
-
-  Eigen::EigenSolver<Eigen::MatrixXd> ev(z);
-  //EigenVector Solver
-  //Matrix3D ones = Matrix3D::Ones(3,3);
-  //EigenSolver<Matrix3D> ev(ones);
-  //cout << "The first eigenvector of the 3x3 matrix of ones is:" << endl << ev.eigenvectors().col(1) << endl;
-
-  for(int i=0;i<2*n; i++)
-  {
-    for(int j=0; j<2*n; j++)
-    {
-      deigVec_real(j,i) = ev.eigenvectors().col(i)(j).real();
-      deigVec_img(j,i) = ev.eigenvectors().col(i)(j).imag();
-    }
-  }
-
-  //Order the eigenvectors
-  //move e-vectors correspnding to e-value outside the unite circle to the left
-
-  Eigen::MatrixXd tempZ_real(2*n, n), tempZ_img(2*n, n);
-  tempZ_real.setZero();
-  tempZ_img.setZero();
-  int c=0;
-
-  for (int i=0;i<2*n;i++)
-  {
-    if ((deigVal_real(i)*deigVal_real(i)+deigVal_img(i)*deigVal_img(i))>1.0) //outside the unit cycle
-    {
-      for(int j=0; j<2*n; j++)
-      {
-        tempZ_real(j,c) = deigVec_real(j,i);
-        tempZ_img(j,c) = deigVec_img(j,i);
-      }
-      c++;
-    }
-  }
-
-  Eigen::MatrixXcd tempZ_comp(2*n, n);
-  for(int i=0;i<2*n;i++)
-  {
-    for(int j=0;j<n;j++)
-    {
-      tempZ_comp.real()(i,j) = tempZ_real(i,j);
-      tempZ_comp.imag()(i,j) = tempZ_img(i,j);
-    }
-  }
-
-  Eigen::MatrixXcd U11(n, n), U21(n, n), X(n, n);
-  for(int i=0;i<n;i++)
+  Eigen::MatrixXd x;
+  if (!advanced_robotics_franka_controllers::solveDiscreteRiccati<Eigen::Dynamic, Eigen::Dynamic>(a, b, q, r, x))
   {
-    for(int j=0;j<n;j++)
-    {
-      U11(i,j) = tempZ_comp(i,j);
-      U21(i,j) = tempZ_comp(i+n,j);
-    }
-  }
-  X = U21*(U11.inverse());
-
-  Eigen::MatrixXd X_sol(n, n);
-  for(int i=0;i<n;i++)
-  {
-    for(int j=0;j<n;j++)
-    {
-      X_sol(i,j) = X.real()(i,j);
-    }
+    std::cerr << "discreteRiccatiEquation: no convergence, returning an empty solution" << std::endl;
+    return Eigen::MatrixXd();
   }
-
-  return X_sol;
+  return x;
 }
 
 static Eigen::Vector3d legGetPhi(Eigen::Isometry3d rotation_matrix1, Eigen::Isometry3d active_r1, Eigen::Vector6d ctrl_pos_ori)
@@ -923,6 +830,8 @@ static void toEulerAngle(double qx, double qy, double qz, double qw, double& rol
   yaw = atan2(siny, cosy);
 
 }
+// closed form coefficients; keep a QuinticSegment instead when the
+// boundary conditions stay fixed over many ticks
 static Eigen::Vector3d QuinticSpline(
                    double time,       ///< Current time
                    double time_0,     ///< Start time
@@ -934,56 +843,10 @@ static Eigen::Vector3d QuinticSpline(
                    double x_dot_f,    ///< End state
                    double x_ddot_f )  ///< End state ddot
 {
-  double a1,a2,a3,a4,a5,a6;
-  double time_s;
-
-  Eigen::Vector3d result;
-
-  if(time < time_0)
-  {
-    result << x_0, x_dot_0, x_ddot_0;
-    return result;
-  }
-  else if (time > time_f)
-  {
-    result << x_f, x_dot_f, x_ddot_f;
-    return result;
-  }
-
-
-  time_s = time_f - time_0;
-  a1=x_0;
-  a2=x_dot_0;
-  a3=x_ddot_0/2.0;
-
-  Eigen::Matrix3d Temp;
-  Temp<<pow(time_s, 3), pow(time_s, 4), pow(time_s, 5),
-        3.0 * pow(time_s, 2), 4.0 * pow(time_s, 3), 5.0 * pow(time_s, 4),
-        6.0 * time_s, 12.0 * pow(time_s, 2), 20.0 * pow(time_s, 3);
-
-  Eigen::Vector3d R_temp;
-  R_temp<<x_f-x_0-x_dot_0*time_s-x_ddot_0*pow(time_s,2)/2.0,
-        x_dot_f-x_dot_0-x_ddot_0*time_s,
-        x_ddot_f-x_ddot_0;
-
-  Eigen::Vector3d RES;
-
-  RES = Temp.inverse()*R_temp;
-
-  a4=RES(0);
-  a5=RES(1);
-  a6=RES(2);
-
-  double time_fs = time - time_0;
-
-  double position = a1+a2*pow(time_fs,1)+a3*pow(time_fs,2)+a4*pow(time_fs,3)+a5*pow(time_fs,4)+a6*pow(time_fs,5);
-  double velocity = a2+2.0*a3*pow(time_fs,1)+3.0*a4*pow(time_fs,2)+4.0*a5*pow(time_fs,3)+5.0*a6*pow(time_fs,4);
-  double acceleration =2.0*a3+6.0*a4*pow(time_fs,1)+12.0*a5*pow(time_fs,2)+20.0*a6*pow(time_fs,3);
-
-
-  result<<position,velocity,acceleration;
-
-  return result;
+  const advanced_robotics_franka_controllers::TrajectoryPoint point =
+      advanced_robotics_franka_controllers::QuinticSegment(time_0, time_f, x_0, x_dot_0, x_ddot_0,
+                                                           x_f, x_dot_f, x_ddot_f).evaluate(time);
+  return Eigen::Vector3d(point.position, point.velocity, point.acceleration);
 }
 
 static inline double lowPassFilter(double input, double prev, double ts, double tau)
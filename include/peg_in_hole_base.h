@@ -260,6 +260,34 @@ namespace PegInHole
         return f_star_zero;    
     }    
 
+    // spiral search force towards origin + traj, traj being the spiral point relative to origin in the
+    // plane normal to dir, e.g. from a SpiralGenerator
+    static Eigen::Vector3d  generateSpiral(const Eigen::Vector3d origin, 
+        const Eigen::Vector3d current_position,
+        const Eigen::Matrix<double, 6, 1> current_velocity,
+        const int dir, //the direction where a peg is inserted
+        const Eigen::Vector2d traj)
+    {
+        Eigen::Vector3d desired_position;
+        Eigen::Vector3d desired_linear_velocity;
+        Eigen::Vector3d f_star;
+        Eigen::Matrix3d K_p;
+        Eigen::Matrix3d K_v;
+
+        K_p << 5000, 0, 0, 0, 5000, 0, 0, 0, 5000;
+        K_v << 200, 0, 0, 0, 200, 0, 0, 0, 200;
+
+        if(dir == 0) desired_position << origin(dir), origin(1) + traj(0), origin(2) + traj(1);
+        if(dir == 1) desired_position << origin(0) + traj(0), origin(dir), origin(2) + traj(1);
+        if(dir == 2) desired_position << origin(0) + traj(0), origin(1) + traj(1), origin(dir);
+        
+        desired_linear_velocity.setZero();
+    
+        f_star = K_p * (desired_position - current_position) + K_v * (desired_linear_velocity- current_velocity.head<3>());  
+            
+        return f_star;
+    }
+
     static Eigen::Vector3d  generateSpiral(const Eigen::Vector3d origin, 
         const Eigen::Vector3d current_position,
         const Eigen::Matrix<double, 6, 1> current_velocity,
@@ -274,28 +302,38 @@ namespace PegInHole
         // double lin_vel = 0.005; 
         Eigen::Vector2d start_point;
         Eigen::Vector2d traj;
+
+        start_point.setZero();
+        traj = DyrosMath::spiral(current_time, init_time, init_time + spiral_duration, start_point, lin_vel, pitch);
+
+        return generateSpiral(origin, current_position, current_velocity, dir, traj);
+    }
+
+    // elliptic spiral search force towards origin + init_rot * traj, traj being the spiral point in the
+    // plane normal to dir of the initial end effector frame, e.g. from a scaled SpiralGenerator
+    static Eigen::Vector3d  generateEllipseSpiralEE(const Eigen::Vector3d origin, 
+        const Eigen::Vector3d current_position,
+        const Eigen::Matrix<double, 6, 1> current_velocity,
+        const Eigen::Matrix3d init_rot,
+        const int dir, //the direction where a peg is inserted
+        const Eigen::Vector2d traj)
+    {
+        Eigen::Vector3d pos_ee;
         Eigen::Vector3d desired_position;
-        Eigen::Vector3d desired_linear_velocity;
         Eigen::Vector3d f_star;
         Eigen::Matrix3d K_p;
         Eigen::Matrix3d K_v;
 
         K_p << 5000, 0, 0, 0, 5000, 0, 0, 0, 5000;
-        K_v << 200, 0, 0, 0, 200, 0, 0, 0, 200;
-
-        if(dir == 0) start_point << origin(1), origin(2);
-        if(dir == 1) start_point << origin(0), origin(2);
-        if(dir == 2) start_point << origin(0), origin(1);
-        
-        traj = DyrosMath::spiral(current_time, init_time, init_time + spiral_duration, start_point, lin_vel, pitch);
+        K_v << 100, 0, 0, 0, 100, 0, 0, 0, 100;
 
-        if(dir == 0) desired_position << origin(dir), traj(0), traj(1);
-        if(dir == 1) desired_position << traj(0), origin(dir), traj(1);
-        if(dir == 2) desired_position << traj(0), traj(1), origin(dir);
+        if(dir == 0) pos_ee << 0, traj(0), traj(1);
+        if(dir == 1) pos_ee << traj(0), 0, traj(1);
+        if(dir == 2) pos_ee << traj(0), traj(1), 0;
         
-        desired_linear_velocity.setZero();
+        desired_position = origin + init_rot*pos_ee;
     
-        f_star = K_p * (desired_position - current_position) + K_v * (desired_linear_velocity- current_velocity.head<3>());  
+        f_star = K_p * (desired_position - current_position) + K_v*(-current_velocity.head<3>());
             
         return f_star;
     }
@@ -316,14 +354,6 @@ namespace PegInHole
         
         Eigen::Vector2d start_point;
         Eigen::Vector2d traj;
-        Eigen::Vector3d pos_ee;
-        Eigen::Vector3d desired_position;
-        Eigen::Vector3d f_star;
-        Eigen::Matrix3d K_p;
-        Eigen::Matrix3d K_v;
-
-        K_p << 5000, 0, 0, 0, 5000, 0, 0, 0, 5000;
-        K_v << 100, 0, 0, 0, 100, 0, 0, 0, 100;
 
         start_point.setZero();
 
@@ -333,15 +363,33 @@ namespace PegInHole
         
         traj = DyrosMath::ellipseSpiral(t, t_0, t_0 + duration, start_point, lin_vel, pitch, n, m);
 
-        if(dir == 0) pos_ee << 0, traj(0), traj(1);
-        if(dir == 1) pos_ee << traj(0), 0, traj(1);
-        if(dir == 2) pos_ee << traj(0), traj(1), 0;
+        return generateEllipseSpiralEE(origin, current_position, current_velocity, init_rot, dir, traj);
+    }
+
+    // holds initial_rotation_M turned by angle about the base frame axis, e.g. the angle of an
+    // OscillationGenerator
+    static Eigen::Matrix<double, 3, 1>  generateRotation(const Eigen::Matrix3d initial_rotation_M, 
+        const Eigen::Matrix3d rotation_M,
+        const Eigen::Matrix<double, 3, 1> current_angular_velocity,
+        const double axis,      // 0 = x-axis, 1 = y-axis, 2 = z-axis
+        const double angle) //Should be radian!!
+    {
+        Eigen::Matrix3d rotation_matrix;
+        Eigen::Matrix3d target_rotation_M;  
+        Eigen::Vector3d delphi_delta;
+        Eigen::Vector3d m_star;
+
+        if(axis == 0) rotation_matrix << 1, 0, 0, 0, cos(angle), -sin(angle), 0, sin(angle), cos(angle);
+        if(axis == 1) rotation_matrix << cos(angle), 0, sin(angle), 0, 1, 0, -sin(angle), 0, cos(angle);
+        if(axis == 2) rotation_matrix << cos(angle), -sin(angle), 0, sin(angle), cos(angle), 0, 0, 0, 1;
         
-        desired_position = origin + init_rot*pos_ee;
-    
-        f_star = K_p * (desired_position - current_position) + K_v*(-current_velocity.head<3>());
-            
-        return f_star;
+        target_rotation_M = rotation_matrix * initial_rotation_M;
+
+        delphi_delta = -0.5 * DyrosMath::getPhi(rotation_M, target_rotation_M);
+        
+        m_star = (1.0) * 200.0* delphi_delta+ 5.0*(-current_angular_velocity);
+                
+        return m_star;
     }
 
     static Eigen::Matrix<double, 3, 1>  generateSpiralWithRotation(const Eigen::Matrix3d initial_rotation_M, 
@@ -356,11 +404,6 @@ namespace PegInHole
     {
         double target_angle = search_angle;
         double ori_change_theta;
-        
-        Eigen::Matrix3d rotation_matrix;
-        Eigen::Matrix3d target_rotation_M;  
-        Eigen::Vector3d delphi_delta;
-        Eigen::Vector3d m_star;
                 
         if(direction == 0.0)
         {
@@ -377,17 +420,7 @@ namespace PegInHole
             ori_change_theta = DyrosMath::cubic(current_time, init_time, init_time + duration, -target_angle, target_angle, 0, 0);
         }            
         
-        if(axis == 0) rotation_matrix << 1, 0, 0, 0, cos(ori_change_theta), -sin(ori_change_theta), 0, sin(ori_change_theta), cos(ori_change_theta);
-        if(axis == 1) rotation_matrix << cos(ori_change_theta), 0, sin(ori_change_theta), 0, 1, 0, -sin(ori_change_theta), 0, cos(ori_change_theta);
-        if(axis == 2) rotation_matrix << cos(ori_change_theta), -sin(ori_change_theta), 0, sin(ori_change_theta), cos(ori_change_theta), 0, 0, 0, 1;
-        
-        target_rotation_M = rotation_matrix * initial_rotation_M;
-
-        delphi_delta = -0.5 * DyrosMath::getPhi(rotation_M, target_rotation_M);
-        
-        m_star = (1.0) * 200.0* delphi_delta+ 5.0*(-current_angular_velocity);
-                
-        return m_star;
+        return generateRotation(initial_rotation_M, rotation_M, current_angular_velocity, axis, ori_change_theta);
     }
 
     static Eigen::Matrix<double, 3, 1>  generateSpiralWithRotationGainEe(const Eigen::Matrix3d initial_rotation_M, 
@@ -456,18 +456,15 @@ namespace PegInHole2
         return f_star;
     }
     
+    // spiral search force towards the spiral point traj, given in the xy plane of frame {A} (e.g. by a
+    // SpiralGenerator started at zero)
     static Vector3d  generateSpiralEE(const Vector3d origin, 
         const Matrix3d ori_init,
         const Vector3d current_position,
         const Vector6d xd,
-        const double pitch,
-        const double lin_vel,
         const Matrix4d T_ea, //the direction where a peg is inserted, wrt {E} .i.e., T_ga
-        const double current_time,
-        const double init_time,
-        const double spiral_duration)
+        const Vector2d traj)
     {
-        Vector2d start_point, traj;
         Vector4d p_a, p_w; // wrt frame {A}
         Vector3d desired_position; // wrt frame {W}
         Vector3d f_star;
@@ -476,13 +473,10 @@ namespace PegInHole2
 
         K_p << 5000, 0, 0, 0, 5000, 0, 0, 0, 5000;
         K_v << 200, 0, 0, 0, 200, 0, 0, 0, 200;                        
-        start_point.setZero();
 
         T_we = PegInHole2::setTransformation(origin, ori_init);
         T_wa = T_we*T_ea;
 
-        traj = DyrosMath::spiral(current_time, init_time, init_time + spiral_duration, start_point, lin_vel, pitch);
-        
         p_a << traj(0), traj(1), 0.0, 1.0;        
         p_w = T_wa*p_a;
 
@@ -494,6 +488,25 @@ namespace PegInHole2
         return f_star;
     }
 
+    static Vector3d  generateSpiralEE(const Vector3d origin, 
+        const Matrix3d ori_init,
+        const Vector3d current_position,
+        const Vector6d xd,
+        const double pitch,
+        const double lin_vel,
+        const Matrix4d T_ea, //the direction where a peg is inserted, wrt {E} .i.e., T_ga
+        const double current_time,
+        const double init_time,
+        const double spiral_duration)
+    {
+        Vector2d start_point, traj;
+
+        start_point.setZero();
+        traj = DyrosMath::spiral(current_time, init_time, init_time + spiral_duration, start_point, lin_vel, pitch);
+
+        return generateSpiralEE(origin, ori_init, current_position, xd, T_ea, traj);
+    }
+
     static Vector3d generateTwistEE(const Matrix3d &ori_init, const Matrix3d &rotation, const Vector6d &xd,
         const double theta_max,
         const double theta_dot,
@@ -0,0 +1,52 @@
+#!/usr/bin/env python
+
+# Converts a TelemetryRecorder file into one tab separated text file per channel.
+# usage: telemetry_to_txt.py <recording.bin> [output_dir]
+
+import os
+import struct
+import sys
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print('usage: telemetry_to_txt.py <recording.bin> [output_dir]')
+        sys.exit(1)
+
+    path = sys.argv[1]
+    out_dir = sys.argv[2] if len(sys.argv) > 2 else os.path.dirname(os.path.abspath(path))
+
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data[:4] != b'ARFT':
+        print('%s is not a telemetry recording' % path)
+        sys.exit(1)
+
+    version, channel_count = struct.unpack_from('<II', data, 4)
+    offset = 12
+    channels = []
+    for _ in range(channel_count):
+        fields, name_length = struct.unpack_from('<II', data, offset)
+        offset += 8
+        name = data[offset:offset + name_length].decode()
+        offset += name_length
+        channels.append((name, fields))
+
+    files = []
+    for name, _ in channels:
+        file_name = os.path.join(out_dir, name + '.txt')
+        if not os.path.isdir(os.path.dirname(file_name)):
+            os.makedirs(os.path.dirname(file_name))
+        files.append(open(file_name, 'w'))
+
+    while offset + 4 <= len(data):
+        channel, = struct.unpack_from('<I', data, offset)
+        fields = channels[channel][1]
+        if offset + 4 + fields * 8 > len(data):
+            break
+        values = struct.unpack_from('<%dd' % fields, data, offset + 4)
+        offset += 4 + fields * 8
+        files[channel].write(''.join('%f\t ' % v for v in values) + '\n')
+
+    for f in files:
+        f.close()
@@ -0,0 +1,120 @@
+#include <advanced_robotics_franka_controllers/cycle_time_monitor.h>
+
+#include <cmath>
+#include <sstream>
+
+#include <ros/ros.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+namespace
+{
+const size_t kHeaderFields = 7;
+}
+
+void CycleTimeMonitor::init(ros::NodeHandle &node_handle)
+{
+  double budget;
+  double publish_rate;
+  node_handle.param("cycle_time_budget", budget, 0.0008);
+  node_handle.param("cycle_time_publish_rate", publish_rate, 1.0);
+  name_ = node_handle.getNamespace();
+  budget_ = budget * 1e6;
+
+  publish_enabled_ = publish_rate > 0.0;
+  if (publish_enabled_)
+  {
+    publish_rate_ = franka_hw::TriggerRate(publish_rate);
+    publisher_.init(node_handle, "cycle_time", 1);
+    publisher_.msg_.data.resize(kHeaderFields + kBins);
+  }
+  reset();
+}
+
+void CycleTimeMonitor::reset()
+{
+  has_last_entry_ = false;
+  count_.store(0, std::memory_order_relaxed);
+  overruns_.store(0, std::memory_order_relaxed);
+  last_ = 0.0;
+  sum_ = 0.0;
+  max_ = 0.0;
+  max_jitter_ = 0.0;
+  for (auto &bin : histogram_)
+    bin.store(0, std::memory_order_relaxed);
+}
+
+void CycleTimeMonitor::begin(const ros::Duration &period)
+{
+  entry_ = Clock::now();
+  if (has_last_entry_)
+  {
+    const double interval = std::chrono::duration<double, std::micro>(entry_ - last_entry_).count();
+    const double jitter = std::abs(interval - period.toSec() * 1e6);
+    if (jitter > max_jitter_)
+      max_jitter_ = jitter;
+  }
+  last_entry_ = entry_;
+  has_last_entry_ = true;
+}
+
+void CycleTimeMonitor::end()
+{
+  last_ = std::chrono::duration<double, std::micro>(Clock::now() - entry_).count();
+  sum_ += last_;
+  if (last_ > max_)
+    max_ = last_;
+  if (last_ > budget_)
+    overruns_.fetch_add(1, std::memory_order_relaxed);
+
+  size_t bin = static_cast<size_t>(last_ / kBinWidth);
+  if (bin >= kBins)
+    bin = kBins - 1;
+  histogram_[bin].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+
+  if (publish_enabled_ && publish_rate_())
+    publish();
+}
+
+void CycleTimeMonitor::publish()
+{
+  if (!publisher_.trylock())
+    return;
+
+  const uint64_t count = count_.load(std::memory_order_relaxed);
+  auto &data = publisher_.msg_.data;
+  data[0] = count;
+  data[1] = overruns_.load(std::memory_order_relaxed);
+  data[2] = budget_;
+  data[3] = last_;
+  data[4] = count > 0 ? sum_ / count : 0.0;
+  data[5] = max_;
+  data[6] = max_jitter_;
+  for (size_t i = 0; i < kBins; ++i)
+    data[kHeaderFields + i] = histogram_[i].load(std::memory_order_relaxed);
+  publisher_.unlockAndPublish();
+}
+
+void CycleTimeMonitor::dump() const
+{
+  const uint64_t count = count_.load(std::memory_order_relaxed);
+  if (count == 0)
+    return;
+
+  std::ostringstream histogram;
+  for (size_t i = 0; i < kBins; ++i)
+  {
+    const uint64_t n = histogram_[i].load(std::memory_order_relaxed);
+    if (n == 0)
+      continue;
+    histogram << "\n  " << i * kBinWidth << (i + 1 < kBins ? " us : " : "+ us : ") << n;
+  }
+
+  ROS_INFO_STREAM(name_ << " cycle time: " << count << " cycles, mean " << sum_ / count << " us, max " << max_
+                  << " us, max jitter " << max_jitter_ << " us, " << overruns_.load(std::memory_order_relaxed)
+                  << " overruns of " << budget_ << " us" << histogram.str());
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,29 @@
+#include <advanced_robotics_franka_controllers/franka_interface_hw.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+void FrankaInterfaceHW::registerInterfaces(const std::string &arm_id, const std::vector<std::string> &joint_names,
+                                           franka_hw::ModelBase &model)
+{
+  for (size_t i = 0; i < 7; ++i)
+  {
+    hardware_interface::JointStateHandle state_handle(joint_names[i], &robot_state_.q[i], &robot_state_.dq[i],
+                                                      &robot_state_.tau_J[i]);
+    joint_state_interface_.registerHandle(state_handle);
+    effort_joint_interface_.registerHandle(hardware_interface::JointHandle(state_handle, &effort_command_[i]));
+    position_joint_interface_.registerHandle(hardware_interface::JointHandle(state_handle, &position_command_[i]));
+    velocity_joint_interface_.registerHandle(hardware_interface::JointHandle(state_handle, &velocity_command_[i]));
+  }
+  franka_state_interface_.registerHandle(franka_hw::FrankaStateHandle(arm_id + "_robot", robot_state_));
+  franka_model_interface_.registerHandle(franka_hw::FrankaModelHandle(arm_id + "_model", model, robot_state_));
+
+  registerInterface(&joint_state_interface_);
+  registerInterface(&effort_joint_interface_);
+  registerInterface(&position_joint_interface_);
+  registerInterface(&velocity_joint_interface_);
+  registerInterface(&franka_state_interface_);
+  registerInterface(&franka_model_interface_);
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,153 @@
+#include <advanced_robotics_franka_controllers/gripper_dispatcher.h>
+
+#include <chrono>
+
+#include <ros/ros.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+namespace
+{
+const size_t kMailboxCapacity = 16;
+}
+
+GripperDispatcher::GripperDispatcher()
+{
+  mailbox_.reserve(kMailboxCapacity);
+  grasp_client_.reset(new actionlib::SimpleActionClient<franka_gripper::GraspAction>("/franka_gripper/grasp", true));
+  move_client_.reset(new actionlib::SimpleActionClient<franka_gripper::MoveAction>("/franka_gripper/move", true));
+
+  running_.store(true, std::memory_order_release);
+  worker_ = std::thread(&GripperDispatcher::workerLoop, this);
+}
+
+GripperDispatcher::~GripperDispatcher()
+{
+  running_.store(false, std::memory_order_release);
+  worker_.join();
+}
+
+void GripperDispatcher::grasp(double width, double speed, double force, double epsilon_inner, double epsilon_outer)
+{
+  GripperCommand command;
+  command.type = GripperCommand::kGrasp;
+  command.width = width;
+  command.speed = speed;
+  command.force = force;
+  command.epsilon_inner = epsilon_inner;
+  command.epsilon_outer = epsilon_outer;
+  post(command);
+}
+
+void GripperDispatcher::move(double width, double speed)
+{
+  GripperCommand command;
+  command.type = GripperCommand::kMove;
+  command.width = width;
+  command.speed = speed;
+  post(command);
+}
+
+void GripperDispatcher::reset()
+{
+  // keep the id, it numbers the commands for the worker
+  const uint64_t id = last_posted_.id;
+  last_posted_ = GripperCommand();
+  last_posted_.id = id;
+}
+
+GripperDispatcher::State GripperDispatcher::state() const
+{
+  if (last_posted_.type == GripperCommand::kNone)
+    return State::kIdle;
+  const uint64_t result = result_.load(std::memory_order_acquire);
+  if (result >> 1 != last_posted_.id)
+    return State::kPending;
+  return result & 1 ? State::kFailed : State::kSucceeded;
+}
+
+void GripperDispatcher::post(const GripperCommand &command)
+{
+  if (command == last_posted_ && state() != State::kFailed)
+    return;
+  GripperCommand numbered = command;
+  numbered.id = last_posted_.id + 1;
+  // a full mailbox keeps last_posted_, so the next call retries
+  if (!mailbox_.push(numbered))
+    return;
+  last_posted_ = numbered;
+  latest_id_.store(numbered.id, std::memory_order_release);
+}
+
+void GripperDispatcher::workerLoop()
+{
+  GripperCommand pending;
+  GripperCommand sent;
+  while (running_.load(std::memory_order_acquire))
+  {
+    // only the newest of the queued commands is sent
+    GripperCommand command;
+    while (mailbox_.pop(command))
+      pending = command;
+    if (pending.type == GripperCommand::kNone || pending.id == sent.id)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      continue;
+    }
+
+    const bool connected = pending.type == GripperCommand::kGrasp
+                               ? grasp_client_->waitForServer(ros::Duration(0.1))
+                               : move_client_->waitForServer(ros::Duration(0.1));
+    if (!connected)
+    {
+      ROS_WARN_THROTTLE(5.0, "GripperDispatcher: waiting for the franka_gripper action servers");
+      continue;
+    }
+    send(pending);
+    sent = pending;
+  }
+}
+
+void GripperDispatcher::send(const GripperCommand &command)
+{
+  auto on_done = [this, command](const actionlib::SimpleClientGoalState &goal_state) {
+    if (latest_id_.load(std::memory_order_acquire) == command.id)
+      done(command, goal_state);
+  };
+
+  if (command.type == GripperCommand::kGrasp)
+  {
+    franka_gripper::GraspGoal goal;
+    goal.width = command.width;
+    goal.speed = command.speed;
+    goal.force = command.force;
+    goal.epsilon.inner = command.epsilon_inner;
+    goal.epsilon.outer = command.epsilon_outer;
+    grasp_client_->sendGoal(goal, [on_done](const actionlib::SimpleClientGoalState &goal_state,
+                                            const franka_gripper::GraspResultConstPtr &result) {
+      on_done(goal_state);
+    });
+  }
+  else
+  {
+    franka_gripper::MoveGoal goal;
+    goal.width = command.width;
+    goal.speed = command.speed;
+    move_client_->sendGoal(goal, [on_done](const actionlib::SimpleClientGoalState &goal_state,
+                                           const franka_gripper::MoveResultConstPtr &result) {
+      on_done(goal_state);
+    });
+  }
+}
+
+void GripperDispatcher::done(const GripperCommand &command, const actionlib::SimpleClientGoalState &goal_state)
+{
+  const bool succeeded = goal_state == actionlib::SimpleClientGoalState::SUCCEEDED;
+  if (!succeeded)
+    ROS_WARN_STREAM("GripperDispatcher: " << (command.type == GripperCommand::kGrasp ? "grasp" : "move")
+                    << " finished with " << goal_state.toString());
+  result_.store(command.id << 1 | (succeeded ? 0 : 1), std::memory_order_release);
+}
+
+}  // namespace advanced_robotics_franka_controllers
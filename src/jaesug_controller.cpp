@@ -1,5 +1,6 @@
 
 #include <advanced_robotics_franka_controllers/jaesug_controller.h>
+#include <advanced_robotics_franka_controllers/damped_pseudo_inverse.h>
 #include <cmath>
 #include <memory>
 
@@ -13,83 +14,11 @@
 namespace advanced_robotics_franka_controllers
 {
 
-  bool JaesugController::init(hardware_interface::RobotHW *robot_hw, ros::NodeHandle &node_handle)
+  bool JaesugController::initController(hardware_interface::RobotHW *robot_hw, ros::NodeHandle &node_handle)
   {
-    std::vector<std::string> joint_names;
-    std::string arm_id;
-    ROS_WARN(
-        "ForceExampleController: Make sure your robot's endeffector is in contact "
-        "with a horizontal surface before starting the controller!");
-    if (!node_handle.getParam("arm_id", arm_id))
-    {
-      ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-      return false;
-    }
-    if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7)
-    {
-      ROS_ERROR(
-          "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-          "controller init!");
-      return false;
-    }
-
-    auto *model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-    if (model_interface == nullptr)
-    {
-      ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-      return false;
-    }
-    try
-    {
-      model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-          model_interface->getHandle(arm_id + "_model"));
-    }
-    catch (hardware_interface::HardwareInterfaceException &ex)
-    {
-      ROS_ERROR_STREAM(
-          "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-      return false;
-    }
 
-    auto *state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-    if (state_interface == nullptr)
-    {
-      ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-      return false;
-    }
-    try
-    {
-      state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-          state_interface->getHandle(arm_id + "_robot"));
-    }
-    catch (hardware_interface::HardwareInterfaceException &ex)
-    {
-      ROS_ERROR_STREAM(
-          "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-      return false;
-    }
-
-    auto *effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-    if (effort_joint_interface == nullptr)
-    {
-      ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-      return false;
-    }
-    for (size_t i = 0; i < 7; ++i)
-    {
-      try
-      {
-        joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-      }
-      catch (const hardware_interface::HardwareInterfaceException &ex)
-      {
-        ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-        return false;
-      }
-    }
-
-    robot_ = new RobotModel();
-    robot_test = new RobotModel();
+    robot_ = new RobotModel<7>();
+    robot_test = new RobotModel<7>();
 
     save_data = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/JS_data/save_data.txt", "w");
     save_data2 = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/JS_data/save_data2.txt", "w");
@@ -108,28 +37,23 @@ namespace advanced_robotics_franka_controllers
     }
     //q_desired = q_init_;
 
+    //q_goal << 0, 0, 0, -M_PI / 2, 0, M_PI / 2, 0;
+    q_goal << 0, -0.89, 0, -2.245, 0, 1.46, 0;
+    homing_ = MultiCubicSegment<7>(start_time_.toSec(), start_time_.toSec() + 3.0, q_init_, q_goal);
+
     const franka::RobotState &robot_state = state_handle_->getRobotState();
     transform_init_ = Eigen::Matrix4d::Map(robot_state.O_T_EE.data());
   }
 
-  void JaesugController::update(const ros::Time &time, const ros::Duration &period)
+  void JaesugController::updateController(const ros::Time &time, const ros::Duration &period)
   {
-
-    const franka::RobotState &robot_state = state_handle_->getRobotState();
-    const std::array<double, 42> &jacobian_array =
-        model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-    const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-    const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-    const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-    Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+    const franka::RobotState &robot_state = snapshot_.robotState();
     Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
     Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-    Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-    Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-    Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+    Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
     Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
     Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
+
     Eigen::Affine3d transform(Eigen::Matrix4d::Map(robot_state.O_T_EE.data()));
     Eigen::Vector3d position(transform.translation());
     Eigen::Matrix<double, 3, 3> rotation_M(transform.rotation());
@@ -156,29 +80,29 @@ namespace advanced_robotics_franka_controllers
     tip3 << -0.6, 0.0, -0.22; //for ori2
     tipVector1 = tip2 - tip1;
     tipVector2 = tip3 - tip1;
-    pos_ee = robot_->getPosition(7, tip1);
-    pos_virtual1 = robot_->getPosition(7, tip2);
-    pos_virtual2 = robot_->getPosition(7, tip3);
     Eigen::Vector3d ZZ;
     Eigen::Vector3d to7;
     ZZ.setZero();
     to7 << 0.088, 0.0, -0.22;
-    pos_wrist = robot_->getPosition(6, ZZ);
 
-    Rot_cur = robot_->getOrientation(7);
-    Rot_wrist = robot_->getOrientation(6);
+    const std::array<RobotModel<7>::KinematicsQuery, 4> queries = {{{7, tip1}, {7, tip2}, {7, tip3}, {6, ZZ}}};
+    std::array<RobotModel<7>::KinematicsResult, 4> points;
+    robot_->getKinematics(queries, points);
+    pos_ee = points[0].position;
+    pos_virtual1 = points[1].position;
+    pos_virtual2 = points[2].position;
+    pos_wrist = points[3].position;
+
+    Rot_cur = points[0].orientation;
+    Rot_wrist = points[3].orientation;
     angle = DyrosMath::rot2Euler(Rot_cur);
     angle_wrist = DyrosMath::rot2Euler(Rot_wrist);
     J_task.resize(6, 7);
 
-    Jacob_ee.resize(6, 7);
-    Jacob_wrist.resize(6, 7);
-    Jacob_ee2.resize(6, 7);
-    Jacob_ee3.resize(6, 7);
-    Jacob_ee = robot_->getJacobian(7, tip1);
-    Jacob_wrist = robot_->getJacobian(6, ZZ);
-    Jacob_ee2 = robot_->getJacobian(7, tip2);
-    Jacob_ee3 = robot_->getJacobian(7, tip3);
+    Jacob_ee = points[0].jacobian;
+    Jacob_ee2 = points[1].jacobian;
+    Jacob_ee3 = points[2].jacobian;
+    Jacob_wrist = points[3].jacobian;
 
     pos_ee_dot.resize(6);
     pos_virtual1_dot.resize(6);
@@ -189,9 +113,6 @@ namespace advanced_robotics_franka_controllers
     pos_virtual1_dot = Jacob_ee2 * dq_filtered_;
     pos_virtual2_dot = Jacob_ee3 * dq_filtered_;
 
-    //q_goal.setZero();
-    //q_goal << 0, 0, 0, -M_PI / 2, 0, M_PI / 2, 0;
-    q_goal << 0, -0.89, 0, -2.245, 0, 1.46, 0;
     //q_desired.setZero();
 
     ros::Duration simulation_time = time - start_time_;
@@ -202,13 +123,9 @@ namespace advanced_robotics_franka_controllers
 
     if (time.toSec() >= start_time_.toSec() && time.toSec() <= (start_time_.toSec() + 3.0))
     {
-      for (int i = 0; i < 7; i++)
-      {
-        q_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec(), start_time_.toSec() + 3.0,
-                                        q_init_(i), q_goal(i), 0.0, 0.0);
-        qd_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec(), start_time_.toSec() + 3.0,
-                                            q_init_(i), q_goal(i), 0.0, 0.0);
-      }
+      const MultiTrajectoryPoint<7> desired = homing_.evaluate(time.toSec());
+      q_desired = desired.position;
+      qd_desired = desired.velocity;
       tau_cmd = (200.0 * (q_desired - q) + 7.0 * (qd_desired - dq_filtered_)); // + coriolis;
     }
     else if (time.toSec() > (start_time_.toSec() + 3.0) && time.toSec() < (start_time_.toSec() + 3.01))
@@ -247,6 +164,15 @@ namespace advanced_robotics_franka_controllers
       Rot_goal = DyrosMath::Euler2rot(angle_goal);
       Rot_i2g = Rot_init.transpose() * Rot_goal;
       axis_angle_goal = acos((Rot_i2g(0, 0) + Rot_i2g(1, 1) + Rot_i2g(2, 2) - 1.0) / 2.0);
+
+      const double task_start = start_time_.toSec() + 3.01;
+      for (int i = 0; i < 3; ++i)
+      {
+        ee_path_[i] = CubicSegment(task_start, task_start + trajectory_time, pos_ee_init(i), pos_ee_goal(i), 0.0, 0.0);
+        angle_path_[i] = CubicSegment(task_start, task_start + trajectory_time, angle_init(i), angle_goal(i), 0.0, 0.0);
+        wrist_path_[i] = CubicSegment(task_start, task_start + trajectory_time, pos_wrist_init(i), pos_wrist_goal(i), 0.0, 0.0);
+      }
+      axis_angle_path_ = CubicSegment(task_start, task_start + trajectory_time, 0.0, axis_angle_goal, 0.0, 0.0);
       tau_cmd.setZero();
     }
     else if (time.toSec() >= (start_time_.toSec() + 3.01) && time.toSec() <= (start_time_.toSec() + 3.01 + trajectory_time + 1.0))
@@ -255,22 +181,16 @@ namespace advanced_robotics_franka_controllers
       {
         for (int i = 0; i < 3; ++i)
         {
-          pos_ee_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-                                               pos_ee_init(i), pos_ee_goal(i), 0.0, 0.0);
-          pos_ee_dot_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-                                                      pos_ee_init(i), pos_ee_goal(i), 0.0, 0.0);
-          // angle_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time, //wrist control
-          //                                     angle_wrist_init(i), angle_goal(i), 0.0, 0.0);
-          // angle_dot_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-          //                                     angle_wrist_init(i), angle_goal(i), 0.0, 0.0);
-          angle_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time, //end effector
-                                              angle_init(i), angle_goal(i), 0.0, 0.0);
-          angle_dot_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-                                                     angle_init(i), angle_goal(i), 0.0, 0.0);
-          pos_wrist_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-                                                  pos_wrist_init(i), pos_wrist_goal(i), 0.0, 0.0);
-          pos_wrist_dot_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-                                                         pos_wrist_init(i), pos_wrist_goal(i), 0.0, 0.0);
+          const TrajectoryPoint ee = ee_path_[i].evaluate(time.toSec());
+          pos_ee_desired(i) = ee.position;
+          pos_ee_dot_desired(i) = ee.velocity;
+          // wrist control: angle_wrist_init instead of angle_init
+          const TrajectoryPoint angle = angle_path_[i].evaluate(time.toSec());
+          angle_desired(i) = angle.position;
+          angle_dot_desired(i) = angle.velocity;
+          const TrajectoryPoint wrist = wrist_path_[i].evaluate(time.toSec());
+          pos_wrist_desired(i) = wrist.position;
+          pos_wrist_dot_desired(i) = wrist.velocity;
         }
 
         if (axis_angle_goal != 0)
@@ -279,8 +199,7 @@ namespace advanced_robotics_franka_controllers
           axis_angle_vector_goal(1) = (Rot_i2g(0, 2) - Rot_i2g(2, 0)) / (2 * sin(axis_angle_goal));
           axis_angle_vector_goal(2) = (Rot_i2g(1, 0) - Rot_i2g(0, 1)) / (2 * sin(axis_angle_goal));
 
-          axis_angle_desired = DyrosMath::cubic(time.toSec(), start_time_.toSec() + 3.01, start_time_.toSec() + 3.01 + trajectory_time,
-                                                0.0, axis_angle_goal, 0.0, 0.0);
+          axis_angle_desired = axis_angle_path_.evaluate(time.toSec()).position;
 
           Rot_desired = DyrosMath::angleaxis2rot(axis_angle_vector_goal, axis_angle_desired);
         }
@@ -542,7 +461,9 @@ namespace advanced_robotics_franka_controllers
     Eigen::Vector3d delphi = -DyrosMath::getPhi(Rot_desired_pre, Rot_desired);
     xd_desired.tail<3>() = kp_ori * delphi + angle_dot_desired;
     //cout<<xd_desired<<endl<<endl;
-    qd_desired = Jtask.transpose() * (Jtask * Jtask.transpose() + Eigen::Matrix6d::Identity() * 0.001).inverse() * xd_desired;
+    Eigen::Matrix<double, 7, 6> Jtask_pinv;
+    dampedPseudoInverse(Jtask, 0.001, Jtask_pinv);
+    qd_desired = Jtask_pinv * xd_desired;
     q_desired = q_desired + qd_desired * 0.001;
   }
 
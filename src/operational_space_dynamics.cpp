@@ -0,0 +1,17 @@
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+void OperationalSpaceDynamics::update(const Matrix7d &mass, const Matrix67d &jacobian)
+{
+  const Eigen::LLT<Matrix7d> mass_llt(mass);
+  const Matrix76d mass_inv_jt = mass_llt.solve(jacobian.transpose());
+  const Matrix6d lambda_inv = jacobian * mass_inv_jt;
+  lambda_ = lambda_inv.ldlt().solve(Matrix6d::Identity());
+  jacobian_bar_ = mass_inv_jt * lambda_;
+  null_space_projector_.noalias() = -jacobian.transpose() * jacobian_bar_.transpose();
+  null_space_projector_.diagonal().array() += 1.0;
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,73 @@
+#include <advanced_robotics_franka_controllers/panda_kinematics.h>
+
+#include <cmath>
+
+namespace advanced_robotics_franka_controllers
+{
+
+constexpr double PandaKinematics::kA[8];
+constexpr double PandaKinematics::kD[8];
+constexpr int PandaKinematics::kTwist[8];
+
+void PandaKinematics::update(const Vector7d &q)
+{
+  Eigen::Vector3d x = Eigen::Vector3d::UnitX();
+  Eigen::Vector3d y = Eigen::Vector3d::UnitY();
+  Eigen::Vector3d z = Eigen::Vector3d::UnitZ();
+  Eigen::Vector3d p = Eigen::Vector3d::Zero();
+
+  // T_i = RotX(alpha) TransX(a) RotZ(q) TransZ(d), applied to the columns of R
+  for (int i = 0; i < 8; ++i)
+  {
+    p += kA[i] * x;
+    if (kTwist[i] == 1)
+    {
+      const Eigen::Vector3d y_prev = y;
+      y = z;
+      z = -y_prev;
+    }
+    else if (kTwist[i] == -1)
+    {
+      const Eigen::Vector3d y_prev = y;
+      y = -z;
+      z = y_prev;
+    }
+    p += kD[i] * z;
+
+    if (i == 7)
+      break;
+    origin_[i] = p;
+    axis_[i] = z;
+
+    const double c = std::cos(q(i));
+    const double s = std::sin(q(i));
+    const Eigen::Vector3d x_prev = x;
+    x = c * x_prev + s * y;
+    y = c * y - s * x_prev;
+  }
+
+  flange_rotation_.col(0) = x;
+  flange_rotation_.col(1) = y;
+  flange_rotation_.col(2) = z;
+  flange_position_ = p;
+}
+
+Eigen::Affine3d PandaKinematics::flange() const
+{
+  Eigen::Affine3d transform = Eigen::Affine3d::Identity();
+  transform.linear() = flange_rotation_;
+  transform.translation() = flange_position_;
+  return transform;
+}
+
+void PandaKinematics::jacobian(const Eigen::Vector3d &tip, Matrix67d &J) const
+{
+  const Eigen::Vector3d point = flange_position_ + flange_rotation_ * tip;
+  for (int i = 0; i < 7; ++i)
+  {
+    J.block<3, 1>(0, i) = axis_[i].cross(point - origin_[i]);
+    J.block<3, 1>(3, i) = axis_[i];
+  }
+}
+
+}  // namespace advanced_robotics_franka_controllers
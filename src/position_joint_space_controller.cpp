@@ -14,7 +14,7 @@
 namespace advanced_robotics_franka_controllers
 {
 
-bool PositionJointSpaceController::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool PositionJointSpaceController::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
 
   //hqp_joint_vel = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/hqp_joint_acc.txt","w");
@@ -23,64 +23,6 @@ bool PositionJointSpaceController::init(hardware_interface::RobotHW* robot_hw, r
 
   joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");  
 
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* position_joint_interface = robot_hw->get<hardware_interface::PositionJointInterface>();
-  if (position_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting position joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(position_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
-
   std::string file_path = "/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE/";
 
   joint_data.open(file_path+"joint_data.txt");
@@ -111,27 +53,19 @@ void PositionJointSpaceController::starting(const ros::Time& time) {
   // q_goal_(5) = 1.696981126;
   // q_goal_(6) = -0.813655319;
 
+  // timed on elapsed_time_, which starts at 0
+  homing_ = MultiCubicSegment<7>(0.0, 5.0, q_init_, q_goal_);
+
   const franka::RobotState &robot_state = state_handle_->getRobotState();
   transform_init_ = Eigen::Matrix4d::Map(robot_state.O_T_EE.data());  
 }
 
 
-void PositionJointSpaceController::update(const ros::Time& time, const ros::Duration& period) {
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void PositionJointSpaceController::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
 
@@ -159,20 +93,7 @@ void PositionJointSpaceController::update(const ros::Time& time, const ros::Dura
 
   elapsed_time_ += period;
 
-  double trajectory_time = 5.0;
-  for(int i=0; i<7;i++)
-  {
-//     q_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-//                                         q_init_(i), q_goal_(i), 0, 0);
-    //  qd_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-    //                                      q_init_(i), q_goal_(i), 0, 0);
-
-    q_desired(i) = DyrosMath::cubic(elapsed_time_.toSec(), 0, 0 + trajectory_time,
-                                         q_init_(i), q_goal_(i), 0, 0);
-
-
-    //q_desired(i) = q_goal_(i);
-  }
+  q_desired = homing_.evaluate(elapsed_time_.toSec()).position;
 //  q_desired = q_desired + qd_desired / 1000;
 
   double kp, kv;
@@ -1,5 +1,6 @@
 
 #include <advanced_robotics_franka_controllers/position_task_space_controller.h>
+#include <advanced_robotics_franka_controllers/damped_pseudo_inverse.h>
 #include <cmath>
 #include <memory>
 
@@ -14,65 +15,10 @@
 namespace advanced_robotics_franka_controllers
 {
 
-bool PositionTaskSpaceController::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool PositionTaskSpaceController::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   //position_data = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/position_data.txt","w");
   //ori_data = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/ori_data.txt","w");
-  
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* position_joint_interface = robot_hw->get<hardware_interface::PositionJointInterface>();
-  if (position_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting position joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(position_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
 
 
     std::string file_path = "/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE/";
@@ -102,30 +48,29 @@ void PositionTaskSpaceController::starting(const ros::Time& time) {
 
   q_desired_last = q_desired_;
 
+  const auto & p_init = transform_init_.translation();
+  Eigen::Vector3d p_goal;
+  //p_goal = p_init + Eigen::Vector3d::Ones() * 0.1;
+  p_goal(0) = p_init(0); //0.85
+  p_goal(1) = p_init(1) - 0.3;
+  p_goal(2) = p_init(2);// + 0.1;
+
+  double trajectory_time = 10.0; //2.0
+  for (int i = 0; i < 3; i++)
+    path_[i] = CubicSegment(0.0, trajectory_time, p_init(i), p_goal(i), 0.0, 0.0);
 }
 
 
-void PositionTaskSpaceController::update(const ros::Time& time, const ros::Duration& period) {
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
+void PositionTaskSpaceController::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
   //franka::RobotState desired_state;
   //desired_state.q = q_desired_;
   //franka::Model desired_model;
   //const std::array<double, 42> &desired_jacobian_array = desired_model.bodyJacobian(franka::Frame::kEndEffector,desired_state);
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   //Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian_d(desired_jacobian_array.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
   //if (print_rate_trigger_()) {
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   //}
@@ -138,22 +83,11 @@ void PositionTaskSpaceController::update(const ros::Time& time, const ros::Durat
 
   Eigen::Vector6d xd_desired;
 
-  Eigen::Vector3d p_goal, p_desired, pd_desired;
+  Eigen::Vector3d p_desired, pd_desired;
 
   const auto & ori_init_ = transform_init_.linear();
   rotation_ = transform.linear();
   
-  const auto & p_init = transform_init_.translation();
-  //p_goal = p_init + Eigen::Vector3d::Ones() * 0.1;
-
-
-    p_goal(0) = p_init(0); //0.85
-    p_goal(1) = p_init(1) - 0.3;
-    p_goal(2) = p_init(2);// + 0.1;
-
-
-    double trajectory_time = 10.0; //2.0
-
 
   ros::Duration simulation_time = time_ - start_time_;
   Eigen::Matrix<double, 7, 1> q_cmd;
@@ -174,14 +108,9 @@ void PositionTaskSpaceController::update(const ros::Time& time, const ros::Durat
  
   for(int i=0; i<3;i++)
   {
-    // p_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-    //                                     p_init(i), p_goal(i), 0, 0);
-    // pd_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-    //                                     p_init(i), p_goal(i), 0, 0);
-    p_desired(i) = DyrosMath::cubic(elapsed_time_.toSec(), 0, 0 + trajectory_time,
-                                        p_init(i), p_goal(i), 0, 0);
-    pd_desired(i) = DyrosMath::cubicDot(elapsed_time_.toSec(), 0, 0 + trajectory_time,
-                                        p_init(i), p_goal(i), 0, 0);
+    const TrajectoryPoint point = path_[i].evaluate(elapsed_time_.toSec());
+    p_desired(i) = point.position;
+    pd_desired(i) = point.velocity;
   }
 
 
@@ -205,9 +134,9 @@ void PositionTaskSpaceController::update(const ros::Time& time, const ros::Durat
   delphi = DyrosMath::getPhi(rotation_, ori_init_);
   xd_desired.tail<3>() = kp_ori * (-0.5) * delphi;
 
-  Eigen::Vector7d qd_desired = jacobian.transpose() * 
-          (jacobian * jacobian.transpose() + Eigen::Matrix6d::Identity() * 0.001)
-          .inverse() * xd_desired;
+  Eigen::Matrix<double, 7, 6> jacobian_pinv;
+  dampedPseudoInverse(jacobian, 0.001, jacobian_pinv);
+  Eigen::Vector7d qd_desired = jacobian_pinv * xd_desired;
 
 
  // q_desired_ += qd_desired * dt;
@@ -1,51 +1,87 @@
 #include <advanced_robotics_franka_controllers/robot_model.h>
+#include <cmath>
 #include <vector>
 
 using namespace std;
 
-RobotModel::RobotModel() {
-	// model_ = new Model();
-	// model_->gravity = Eigen::Vector3d(0., 0., -9.81);
+template <int DOF>
+RobotModel<DOF>::RobotModel() {
+	q_rbdl_.setZero(DOF);
+	qdot_rbdl_.setZero(DOF);
+	qddot_rbdl_.setZero(DOF);
+	zero_rbdl_.setZero(DOF);
+	tau_rbdl_.setZero(DOF);
+	result_rbdl_.setZero(DOF);
+	J_rbdl_.setZero(6, DOF);
+	M_rbdl_.setZero(DOF, DOF);
 
-
-	q_rbdl_.resize(dof);
-	qdot_rbdl_.resize(dof);
-	q_rbdl_.setZero();
-	qdot_rbdl_.setZero();
-	qddot_rbdl_.resize(m_na_ + 5);
-	qddot_rbdl_.setZero();
-
-	m_J_.resize(6, m_na_ + 2); // 
 	m_J_.setZero();
-
-	m_Ori_.resize(3, 3);
 	m_pos_.setZero();
 	m_Ori_.setZero();
 	m_Trans_.linear().setZero();
 	m_Trans_.translation().setZero();
 
-	q_real_.resize(m_nv_);
-	q_real_.setZero();
-	qdot_real_.resize(m_nv_);
-	qdot_real_.setZero();
+	m_M_.setZero();
+	m_g_.setZero();
+	m_nle_.setZero();
+	m_qddot_.setZero();
 
 	setRobot();
 }
-RobotModel::~RobotModel() {
+template <int DOF>
+RobotModel<DOF>::~RobotModel() {
 
 }
 
-void RobotModel::setRobot() {
+template <int DOF>
+void RobotModel<DOF>::setRobot() {
 
 	model_ = make_shared<Model>();
 	model_->gravity = Vector3d(0., 0, -9.81);
 
 ///////// Manipulator //////////
-	for (int i = 0; i < dof; i++) {
-		mass_[i] = 1.0;
-		inertia_[i] = Vector3d(0.001, 0.001, 0.001);
+	// Inertial parameters identified by Gaz et al., "Dynamic Identification of
+	// the Franka Emika Panda Robot With Retrieval of Feasible Parameters Using
+	// Penalty-Based Optimization" (RA-L 2019). Center of mass and inertia about
+	// it are given in the DH link frames; the hand is not included.
+	mass_[0] = 4.970684;
+	mass_[1] = 0.646926;
+	mass_[2] = 3.228604;
+	mass_[3] = 3.587895;
+	mass_[4] = 1.225946;
+	mass_[5] = 1.666555;
+	mass_[6] = 7.35522e-01;
+
+	com_position_[0] = Vector3d(3.875e-03, 2.081e-03, -0.1750);
+	com_position_[1] = Vector3d(-3.141e-03, -2.872e-02, 3.495e-03);
+	com_position_[2] = Vector3d(2.7518e-02, 3.9252e-02, -6.6502e-02);
+	com_position_[3] = Vector3d(-5.317e-02, 1.04419e-01, 2.7454e-02);
+	com_position_[4] = Vector3d(-1.1953e-02, 4.1065e-02, -3.8437e-02);
+	com_position_[5] = Vector3d(6.0149e-02, -1.4117e-02, -1.0517e-02);
+	com_position_[6] = Vector3d(1.0517e-02, -4.252e-03, 6.1597e-02);
+
+	// Ixx, Ixy, Ixz, Iyy, Iyz, Izz
+	const double inertia[DOF][6] = {
+		{7.03370e-01, -1.39000e-04, 6.77200e-03, 7.06610e-01, 1.91690e-02, 9.11700e-03},
+		{7.96200e-03, -3.92500e-03, 1.02540e-02, 2.81100e-02, 7.04000e-04, 2.59950e-02},
+		{3.72420e-02, -4.76100e-03, -1.13960e-02, 3.61550e-02, -1.28050e-02, 1.08300e-02},
+		{2.58530e-02, 7.79600e-03, -1.33200e-03, 1.95520e-02, 8.64100e-03, 2.83230e-02},
+		{3.55490e-02, -2.11700e-03, -4.03700e-03, 2.94740e-02, 2.29000e-04, 8.62700e-03},
+		{1.96400e-03, 1.09000e-04, -1.15800e-03, 4.35400e-03, 3.41000e-04, 5.43300e-03},
+		{1.25160e-02, -4.28000e-04, -1.19600e-03, 1.00270e-02, -7.41000e-04, 4.81500e-03}};
+	for (int i = 0; i < DOF; i++) {
+		const double *I = inertia[i];
+		inertia_[i] << I[0], I[1], I[2],
+		               I[1], I[3], I[4],
+		               I[2], I[4], I[5];
 	}
 
+	// orientation of the DH link frames at q = 0: rotations about x by the
+	// accumulated alpha (0, -pi/2, pi/2, pi/2, -pi/2, pi/2, pi/2)
+	const double alpha_sum[DOF] = {0.0, -M_PI_2, 0.0, M_PI_2, 0.0, M_PI_2, M_PI};
+	for (int i = 0; i < DOF; i++)
+		dh_rotation_[i] = AngleAxisd(alpha_sum[i], Vector3d::UnitX()).toRotationMatrix();
+
 	axis_[0] = Eigen::Vector3d::UnitZ();
 	axis_[1] = Eigen::Vector3d::UnitY();
 	axis_[2] = Eigen::Vector3d::UnitZ();
@@ -66,27 +102,17 @@ void RobotModel::setRobot() {
 
 	joint_position_local_[0] = joint_position_global_[0];
 
-	for (int i = 1; i < dof; i++)
+	for (int i = 1; i < DOF; i++)
 		joint_position_local_[i] = joint_position_global_[i] - joint_position_global_[i - 1];
 
 
-// Only manipulator 
-	com_position_[0] = Vector3d(0.0, -0.0346, 0.2575);
-	com_position_[1] = Vector3d(0.0, 0.0344, 0.4094);
-	com_position_[2] = Vector3d(0.0334, 0.0265, 0.6076);
-	com_position_[3] = Vector3d(0.0331, -0.0265, 0.6914);
-	com_position_[4] = Vector3d(0.0013, 0.0423, 0.9243);
-	com_position_[5] = Vector3d(0.0421, -0.0103, 1.0482);
-	com_position_[6] = Vector3d(0.1, -0.0120, 0.9536);
-
-
-
-	for (int i = 0; i < dof; i++)
-		com_position_[i] -= joint_position_global_[i];
-
-
+	// the RBDL body frames are parallel to the base at q = 0
+	for (int i = 0; i < DOF; i++) {
+		com_position_[i] = dh_rotation_[i] * com_position_[i];
+		inertia_[i] = dh_rotation_[i] * inertia_[i] * dh_rotation_[i].transpose();
+	}
 
-	for (int i = 0; i < dof; i++) {
+	for (int i = 0; i < DOF; i++) {
 		body_[i] = Body(mass_[i], com_position_[i], inertia_[i]);
 		joint_[i] = Joint(JointTypeRevolute, axis_[i]);
 
@@ -96,10 +122,13 @@ void RobotModel::setRobot() {
 			body_id_[i] = model_->AddBody(body_id_[i - 1], Math::Xtrans(joint_position_local_[i]), joint_[i], body_[i]);
 	}
 
+	// the getters do not update kinematics; start from the zero configuration
+	UpdateKinematics(*model_, q_rbdl_, qdot_rbdl_, qddot_rbdl_);
+
 
 	////////////////////////////////////////////////////////////////
 
-	// for (int i = 0; i < dof; i++) {
+	// for (int i = 0; i < DOF; i++) {
 	// 	mass_[i] = 1.0;
 	// 	inertia_[i] = Vector3d(0.001, 0.001, 0.001);
 	// }
@@ -122,7 +151,7 @@ void RobotModel::setRobot() {
 
 	// joint_position_local_[0] = joint_position_global_[0];
 
-	// for (int i = 1; i < dof; i++)
+	// for (int i = 1; i < DOF; i++)
 	// 	joint_position_local_[i] = joint_position_global_[i] - joint_position_global_[i - 1];
 
 	// com_position_[0] = Vector3d(0.0, -0.0346, 0.2575);
@@ -133,10 +162,10 @@ void RobotModel::setRobot() {
 	// com_position_[5] = Vector3d(0.0421, -0.0103, 1.0482);
 	// com_position_[6] = Vector3d(0.1, -0.0120, 0.9536);
 
-	// for (int i = 0; i < dof; i++)
+	// for (int i = 0; i < DOF; i++)
 	// 	com_position_[i] -= joint_position_global_[i];
 
-	// for (int i = 0; i < dof; i++) {
+	// for (int i = 0; i < DOF; i++) {
 	// 	body_[i] = Body(mass_[i], com_position_[i], inertia_[i]);
 	// 	joint_[i] = Joint(JointTypeRevolute, axis_[i]);
 
@@ -151,37 +180,99 @@ void RobotModel::setRobot() {
 
 
 }
-void RobotModel::Jacobian(const int & frame_id, Vector3d& tip_pos) { //?
-	MatrixXd J_temp(6, dof);
-	J_temp.setZero();
-
-    //tip_pos = com_position_[frame_id - 1];
-
-	CalcPointJacobian6D(*model_, q_rbdl_, body_id_[frame_id - 1], tip_pos, J_temp, true);
-	
-	m_J_ = J_temp;
-	J_temp = m_J_;
-	for (int i = 0; i < 2; i++) {
-		m_J_.block(i * 3, 0, 3, dof) = J_temp.block(3 - i * 3, 0, 3, dof);
+template <int DOF>
+void RobotModel<DOF>::getJacobian(const int & frame_id, const Vector3d& tip_pos, Ref<Matrix6Qd> J) {
+	// RBDL only writes the columns of the supporting joints
+	J_rbdl_.setZero();
+	CalcPointJacobian6D(*model_, q_rbdl_, body_id_[frame_id - 1], tip_pos, J_rbdl_, false);
+
+	// RBDL orders the rows [angular; linear]
+	J.template topRows<3>() = J_rbdl_.bottomRows(3);
+	J.template bottomRows<3>() = J_rbdl_.topRows(3);
+}
+template <int DOF>
+void RobotModel<DOF>::getKinematics(const KinematicsQuery *queries, KinematicsResult *results, int count) {
+	for (int i = 0; i < count; i++) {
+		const KinematicsQuery &query = queries[i];
+		KinematicsResult &result = results[i];
+
+		int first = 0;
+		while (first < i && queries[first].frame_id != query.frame_id)
+			first++;
+
+		if (first == i) {
+			Position(query.frame_id, query.tip_pos);
+			Orientation(query.frame_id);
+			result.position = m_pos_;
+			result.orientation = m_Ori_;
+			getJacobian(query.frame_id, query.tip_pos, result.jacobian);
+			continue;
+		}
+
+		// same body: v_tip = v_first + w x r
+		const KinematicsResult &known = results[first];
+		const Vector3d r = known.orientation * (query.tip_pos - queries[first].tip_pos);
+		result.position = known.position + r;
+		result.orientation = known.orientation;
+		result.jacobian = known.jacobian;
+		for (int j = 0; j < DOF; j++)
+			result.jacobian.template block<3, 1>(0, j) += known.jacobian.template block<3, 1>(3, j).cross(r);
 	}
 }
-void RobotModel::Position(const int & frame_id, Vector3d& tip_pos) { // for mobile
-	m_pos_ = CalcBodyToBaseCoordinates(*model_, q_rbdl_, body_id_[frame_id - 1], tip_pos, true);
+template <int DOF>
+void RobotModel<DOF>::Position(const int & frame_id, const Vector3d& tip_pos) { // for mobile
+	m_pos_ = CalcBodyToBaseCoordinates(*model_, q_rbdl_, body_id_[frame_id - 1], tip_pos, false);
 }
-void RobotModel::Orientation(const int & frame_id) { // for mobile
-	m_Ori_ = CalcBodyWorldOrientation(*model_, q_rbdl_, body_id_[frame_id - 1], true).transpose();
+template <int DOF>
+void RobotModel<DOF>::Orientation(const int & frame_id) { // for mobile
+	m_Ori_ = CalcBodyWorldOrientation(*model_, q_rbdl_, body_id_[frame_id - 1], false).transpose();
 }
-void RobotModel::Transformation(const int & frame_id, Vector3d& tip_pos) { // for mobile
+template <int DOF>
+void RobotModel<DOF>::Transformation(const int & frame_id, const Vector3d& tip_pos) { // for mobile
 	Position(frame_id, tip_pos);
 	Orientation(frame_id);
 	m_Trans_.linear() = m_Ori_;
 	m_Trans_.translation() = m_pos_;
 }
-void RobotModel::getUpdateKinematics(const VectorXd & q, const VectorXd & qdot) { // for mobile
+template <int DOF>
+void RobotModel<DOF>::getUpdateKinematics(const VectorQd & q, const VectorQd & qdot) { // for mobile
 	q_rbdl_ = q;
-	qdot_rbdl_ = qdot;	
+	qdot_rbdl_ = qdot;
 	qddot_rbdl_.setZero();
 	UpdateKinematics(*model_, q_rbdl_, qdot_rbdl_, qddot_rbdl_);
 
 }
+template <int DOF>
+void RobotModel<DOF>::MassMatrix() {
+	M_rbdl_.setZero();
+	CompositeRigidBodyAlgorithm(*model_, q_rbdl_, M_rbdl_, false);
+	m_M_ = M_rbdl_;
+}
+template <int DOF>
+void RobotModel<DOF>::GravityTorque() {
+	NonlinearEffects(*model_, q_rbdl_, zero_rbdl_, result_rbdl_);
+	m_g_ = result_rbdl_;
+}
+template <int DOF>
+void RobotModel<DOF>::NonlinearTorque() {
+	NonlinearEffects(*model_, q_rbdl_, qdot_rbdl_, result_rbdl_);
+	m_nle_ = result_rbdl_;
+}
+template <int DOF>
+void RobotModel<DOF>::CoriolisTorque() {
+	// one RNEA pass without gravity instead of nonlinear effects minus gravity
+	const Math::Vector3d gravity = model_->gravity;
+	model_->gravity.setZero();
+	NonlinearEffects(*model_, q_rbdl_, qdot_rbdl_, result_rbdl_);
+	model_->gravity = gravity;
+	m_c_ = result_rbdl_;
+}
+template <int DOF>
+void RobotModel<DOF>::Acceleration(const VectorQd & tau) {
+	tau_rbdl_ = tau;
+	ForwardDynamics(*model_, q_rbdl_, qdot_rbdl_, tau_rbdl_, result_rbdl_);
+	m_qddot_ = result_rbdl_;
+}
 
+// the link geometry in setRobot() is the panda's
+template class RobotModel<7>;
@@ -0,0 +1,196 @@
+#include <advanced_robotics_franka_controllers/robot_state_recording.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ros/ros.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+namespace
+{
+const uint32_t kRecordingVersion = 1;
+
+struct RecordingHeader
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t tick_size;
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t padding;
+};
+}  // namespace
+
+void toRecordedState(const franka::RobotState &robot_state, RecordedRobotState &recorded)
+{
+#define ROBOT_STATE_RECORD_COPY(field) recorded.field = robot_state.field;
+  ROBOT_STATE_RECORD_FIELDS(ROBOT_STATE_RECORD_COPY)
+#undef ROBOT_STATE_RECORD_COPY
+  recorded.time_ms = robot_state.time.toMSec();
+}
+
+void fromRecordedState(const RecordedRobotState &recorded, franka::RobotState &robot_state)
+{
+#define ROBOT_STATE_RECORD_COPY(field) robot_state.field = recorded.field;
+  ROBOT_STATE_RECORD_FIELDS(ROBOT_STATE_RECORD_COPY)
+#undef ROBOT_STATE_RECORD_COPY
+  robot_state.time = franka::Duration(recorded.time_ms);
+}
+
+
+RobotStateRecorder::~RobotStateRecorder()
+{
+  close();
+}
+
+bool RobotStateRecorder::open(const std::string &file_name, size_t capacity)
+{
+  close();
+
+  fd_ = ::open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0)
+  {
+    ROS_ERROR_STREAM("RobotStateRecorder: Could not open " << file_name);
+    return false;
+  }
+  map_size_ = sizeof(RecordingHeader) + capacity * sizeof(RecordedTick);
+  if (ftruncate(fd_, map_size_) != 0)
+  {
+    ROS_ERROR_STREAM("RobotStateRecorder: Could not allocate " << map_size_ << " bytes for " << file_name);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+  if (map_ == MAP_FAILED)
+  {
+    ROS_ERROR_STREAM("RobotStateRecorder: Could not map " << file_name);
+    map_ = nullptr;
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  RecordingHeader *header = static_cast<RecordingHeader *>(map_);
+  std::memcpy(header->magic, "ARFR", 4);
+  header->version = kRecordingVersion;
+  header->tick_size = sizeof(RecordedTick);
+  header->count = 0;
+
+  ticks_ = reinterpret_cast<RecordedTick *>(header + 1);
+  capacity_ = capacity;
+  dropped_ = 0;
+  return true;
+}
+
+void RobotStateRecorder::close()
+{
+  if (map_ == nullptr)
+    return;
+
+  const size_t file_size = sizeof(RecordingHeader) + size() * sizeof(RecordedTick);
+  munmap(map_, map_size_);
+  if (ftruncate(fd_, file_size) != 0)
+    ROS_WARN("RobotStateRecorder: Could not trim the recording");
+  ::close(fd_);
+
+  if (dropped_ > 0)
+    ROS_WARN_STREAM("RobotStateRecorder: recording full, " << dropped_ << " ticks were dropped");
+
+  fd_ = -1;
+  map_ = nullptr;
+  ticks_ = nullptr;
+}
+
+size_t RobotStateRecorder::size() const
+{
+  return map_ == nullptr ? 0 : static_cast<const RecordingHeader *>(map_)->count;
+}
+
+bool RobotStateRecorder::append(const ros::Time &time, const ros::Duration &period,
+                                const RobotStateSnapshot &snapshot)
+{
+  RecordingHeader *header = static_cast<RecordingHeader *>(map_);
+  if (header->count >= capacity_)
+  {
+    ++dropped_;
+    return false;
+  }
+
+  RecordedTick &tick = ticks_[header->count];
+  tick.time_ns = time.toNSec();
+  tick.period_ns = period.toNSec();
+  toRecordedState(snapshot.robotState(), tick.state);
+  tick.jacobian = snapshot.jacobian();
+  tick.mass = snapshot.mass();
+  tick.coriolis = snapshot.coriolis();
+  tick.gravity = snapshot.gravity();
+  ++header->count;
+  return true;
+}
+
+
+RobotStateRecording::~RobotStateRecording()
+{
+  close();
+}
+
+bool RobotStateRecording::open(const std::string &file_name)
+{
+  close();
+
+  const int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR_STREAM("RobotStateRecording: Could not open " << file_name);
+    return false;
+  }
+  struct stat st;
+  fstat(fd, &st);
+  map_size_ = st.st_size;
+  if (map_size_ < sizeof(RecordingHeader))
+  {
+    ROS_ERROR_STREAM("RobotStateRecording: " << file_name << " is too short");
+    ::close(fd);
+    return false;
+  }
+  map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map_ == MAP_FAILED)
+  {
+    ROS_ERROR_STREAM("RobotStateRecording: Could not map " << file_name);
+    map_ = nullptr;
+    return false;
+  }
+
+  const RecordingHeader *header = static_cast<const RecordingHeader *>(map_);
+  if (std::memcmp(header->magic, "ARFR", 4) != 0 || header->version != kRecordingVersion ||
+      header->tick_size != sizeof(RecordedTick))
+  {
+    ROS_ERROR_STREAM("RobotStateRecording: " << file_name << " is not a compatible recording");
+    close();
+    return false;
+  }
+
+  ticks_ = reinterpret_cast<const RecordedTick *>(header + 1);
+  size_ = std::min<size_t>(header->count, (map_size_ - sizeof(RecordingHeader)) / sizeof(RecordedTick));
+  madvise(map_, map_size_, MADV_SEQUENTIAL);
+  return true;
+}
+
+void RobotStateRecording::close()
+{
+  if (map_ != nullptr)
+    munmap(map_, map_size_);
+  map_ = nullptr;
+  ticks_ = nullptr;
+  size_ = 0;
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,175 @@
+#include <advanced_robotics_franka_controllers/rt_logger.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+#include <ros/ros.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+namespace
+{
+void appendValue(std::string &text, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+void appendValue(std::string &text, const char *format, ...)
+{
+  char buffer[64];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  text += buffer;
+}
+
+void appendArg(std::string &text, const RtLogMessage &message, const RtLogMessage::Arg &arg)
+{
+  const RtLogMessage::Value *value = message.values + arg.offset;
+  switch (arg.type)
+  {
+    case RtLogMessage::kInteger:
+      appendValue(text, "%" PRId64, value->integer);
+      break;
+    case RtLogMessage::kReal:
+      appendValue(text, "%g", value->real);
+      break;
+    case RtLogMessage::kString:
+      text += value->string != nullptr ? value->string : "(null)";
+      break;
+    case RtLogMessage::kMatrix:
+      // vectors on one line, matrices one row per line
+      for (int r = 0; r < arg.rows; ++r)
+      {
+        if (r > 0)
+          text += arg.cols == 1 ? " " : "\n";
+        for (int c = 0; c < arg.cols; ++c)
+        {
+          if (c > 0)
+            text += ' ';
+          appendValue(text, "%g", (value++)->real);
+        }
+      }
+      break;
+  }
+}
+
+std::string format(const RtLogMessage &message)
+{
+  std::string text;
+  size_t arg = 0;
+  for (const char *c = message.format; *c != '\0'; ++c)
+  {
+    if (c[0] == '{' && c[1] == '}')
+    {
+      if (arg < message.arg_count)
+        appendArg(text, message, message.args[arg]);
+      else
+        text += "{?}";
+      ++arg;
+      ++c;
+    }
+    else
+      text += *c;
+  }
+  return text;
+}
+}  // namespace
+
+RtLogger &RtLogger::instance()
+{
+  static RtLogger logger;
+  return logger;
+}
+
+RtLogger::RtLogger()
+{
+  queue_.reserve(kCapacity);
+  running_.store(true, std::memory_order_release);
+  output_ = std::thread(&RtLogger::outputLoop, this);
+}
+
+RtLogger::~RtLogger()
+{
+  running_.store(false, std::memory_order_release);
+  output_.join();
+}
+
+RtLogMessage::Arg *RtLogger::addArg(RtLogMessage &message, RtLogMessage::ArgType type, Eigen::Index rows,
+                                    Eigen::Index cols)
+{
+  const size_t size = rows * cols;
+  if (message.arg_count >= RtLogMessage::kMaxArgs || message.value_count + size > RtLogMessage::kMaxValues)
+    return nullptr;
+
+  RtLogMessage::Arg &arg = message.args[message.arg_count++];
+  arg.type = type;
+  arg.rows = rows;
+  arg.cols = cols;
+  arg.offset = message.value_count;
+  message.value_count += size;
+  return &arg;
+}
+
+void RtLogger::push(const RtLogMessage &message)
+{
+  if (producer_busy_.test_and_set(std::memory_order_acquire))
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (!queue_.push(message))
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  producer_busy_.clear(std::memory_order_release);
+}
+
+void RtLogger::outputLoop()
+{
+  RtLogMessage message;
+  uint64_t reported_drops = 0;
+  while (true)
+  {
+    const bool running = running_.load(std::memory_order_acquire);
+    while (queue_.pop(message))
+    {
+      const std::string text = format(message);
+      switch (message.level)
+      {
+        case RtLogLevel::kInfo:
+          ROS_INFO("%s", text.c_str());
+          break;
+        case RtLogLevel::kWarn:
+          ROS_WARN("%s", text.c_str());
+          break;
+        case RtLogLevel::kError:
+          ROS_ERROR("%s", text.c_str());
+          break;
+      }
+    }
+
+    const uint64_t drops = dropped();
+    if (drops != reported_drops)
+    {
+      ROS_WARN_STREAM("RtLogger: " << drops - reported_drops << " messages were dropped");
+      reported_drops = drops;
+    }
+
+    if (!running)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+bool RtLogSite::ready(double period)
+{
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch()).count();
+  int64_t last = last_ns_.load(std::memory_order_relaxed);
+  if (last != INT64_MIN && now - last < static_cast<int64_t>(period * 1e9))
+    return false;
+  return last_ns_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,264 @@
+#include <advanced_robotics_franka_controllers/simulated_robot_hw.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/robot_model.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+namespace
+{
+const std::array<double, 7> kTorqueLimit = {{87, 87, 87, 87, 12, 12, 12}};
+const std::array<double, 7> kStiffness = {{600, 600, 600, 600, 250, 150, 50}};
+const std::array<double, 7> kDamping = {{50, 50, 50, 20, 20, 20, 10}};
+const double kViscousFriction = 0.1;
+
+Eigen::Affine3d toAffine(const std::array<double, 16> &transform)
+{
+  Eigen::Affine3d affine(Eigen::Matrix4d::Map(transform.data()));
+  if (transform[15] == 0.0)  // unset franka::RobotState field
+    affine.setIdentity();
+  return affine;
+}
+
+// flange pose in the joint 7 body frame
+Eigen::Affine3d flangeTransform()
+{
+  Eigen::Affine3d transform = Eigen::Affine3d::Identity();
+  transform.linear() = Eigen::Vector3d(1, -1, -1).asDiagonal();
+  transform.translation() = Eigen::Vector3d(0, 0, -0.107);
+  return transform;
+}
+}  // namespace
+
+SimulatedModel::SimulatedModel() : robot_(new RobotModel<7>())
+{
+}
+
+SimulatedModel::~SimulatedModel() = default;
+
+void SimulatedModel::updateKinematics(const std::array<double, 7> &q, const std::array<double, 7> &dq) const
+{
+  robot_->getUpdateKinematics(Eigen::Matrix<double, 7, 1>::Map(q.data()),
+                              Eigen::Matrix<double, 7, 1>::Map(dq.data()));
+}
+
+std::array<double, 16> SimulatedModel::pose(franka::Frame frame, const std::array<double, 7> &q,
+                                            const std::array<double, 16> &F_T_EE,
+                                            const std::array<double, 16> &EE_T_K) const
+{
+  updateKinematics(q, std::array<double, 7>{});
+
+  const int joint = std::min(static_cast<int>(frame), 6) + 1;
+  Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  Eigen::Affine3d transform = robot_->getTransformation(joint, origin);
+  if (frame >= franka::Frame::kFlange)
+    transform = transform * flangeTransform();
+  if (frame >= franka::Frame::kEndEffector)
+    transform = transform * toAffine(F_T_EE);
+  if (frame >= franka::Frame::kStiffness)
+    transform = transform * toAffine(EE_T_K);
+
+  std::array<double, 16> pose;
+  Eigen::Matrix4d::Map(pose.data()) = transform.matrix();
+  return pose;
+}
+
+std::array<double, 42> SimulatedModel::zeroJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                                    const std::array<double, 16> &F_T_EE,
+                                                    const std::array<double, 16> &EE_T_K) const
+{
+  const int joint = std::min(static_cast<int>(frame), 6) + 1;
+  const std::array<double, 16> frame_pose = pose(frame, q, F_T_EE, EE_T_K);
+
+  Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  const Eigen::Affine3d body = robot_->getTransformation(joint, origin);
+  Eigen::Vector3d tip = body.inverse() * Eigen::Vector3d(frame_pose[12], frame_pose[13], frame_pose[14]);
+
+  std::array<double, 42> jacobian{};
+  Eigen::Map<Eigen::Matrix<double, 6, 7>> J(jacobian.data());
+  robot_->getJacobian(joint, tip, J);
+  return jacobian;
+}
+
+std::array<double, 42> SimulatedModel::bodyJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                                    const std::array<double, 16> &F_T_EE,
+                                                    const std::array<double, 16> &EE_T_K) const
+{
+  const std::array<double, 16> frame_pose = pose(frame, q, F_T_EE, EE_T_K);
+  const Eigen::Matrix3d rotation = Eigen::Matrix4d::Map(frame_pose.data()).topLeftCorner<3, 3>();
+
+  std::array<double, 42> jacobian = zeroJacobian(frame, q, F_T_EE, EE_T_K);
+  Eigen::Map<Eigen::Matrix<double, 6, 7>> J(jacobian.data());
+  J.topRows<3>() = rotation.transpose() * J.topRows<3>();
+  J.bottomRows<3>() = rotation.transpose() * J.bottomRows<3>();
+  return jacobian;
+}
+
+std::array<double, 49> SimulatedModel::mass(const std::array<double, 7> &q, const std::array<double, 9> &I_total,
+                                            double m_total, const std::array<double, 3> &F_x_Ctotal) const
+{
+  updateKinematics(q, std::array<double, 7>{});
+  std::array<double, 49> mass;
+  Eigen::Matrix<double, 7, 7>::Map(mass.data()) = robot_->getMassMatrix();
+  return mass;
+}
+
+std::array<double, 7> SimulatedModel::coriolis(const std::array<double, 7> &q, const std::array<double, 7> &dq,
+                                               const std::array<double, 9> &I_total, double m_total,
+                                               const std::array<double, 3> &F_x_Ctotal) const
+{
+  updateKinematics(q, dq);
+  std::array<double, 7> coriolis;
+  Eigen::Matrix<double, 7, 1>::Map(coriolis.data()) = robot_->getCoriolis();
+  return coriolis;
+}
+
+std::array<double, 7> SimulatedModel::gravity(const std::array<double, 7> &q, double m_total,
+                                              const std::array<double, 3> &F_x_Ctotal,
+                                              const std::array<double, 3> &gravity_earth) const
+{
+  updateKinematics(q, std::array<double, 7>{});
+  std::array<double, 7> gravity;
+  Eigen::Matrix<double, 7, 1>::Map(gravity.data()) = robot_->getGravity();
+  return gravity;
+}
+
+std::array<double, 7> SimulatedModel::forwardDynamics(const std::array<double, 7> &q,
+                                                      const std::array<double, 7> &dq,
+                                                      const std::array<double, 7> &tau) const
+{
+  updateKinematics(q, dq);
+  std::array<double, 7> ddq;
+  Eigen::Matrix<double, 7, 1>::Map(ddq.data()) =
+      robot_->getForwardDynamics(Eigen::Matrix<double, 7, 1>::Map(tau.data()));
+  return ddq;
+}
+
+
+SimulatedRobotHW::SimulatedRobotHW(const std::string &arm_id, const std::vector<std::string> &joint_names,
+                                   const std::array<double, 7> &q_init)
+{
+  robot_state_.q = q_init;
+  robot_state_.q_d = q_init;
+
+  // franka hand
+  Eigen::Affine3d F_T_EE = Eigen::Affine3d::Identity();
+  F_T_EE.linear() = Eigen::AngleAxisd(-M_PI_4, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+  F_T_EE.translation() = Eigen::Vector3d(0, 0, 0.1034);
+  Eigen::Matrix4d::Map(robot_state_.F_T_EE.data()) = F_T_EE.matrix();
+  Eigen::Matrix4d::Map(robot_state_.EE_T_K.data()) = Eigen::Matrix4d::Identity();
+  robot_state_.m_ee = 0.73;
+
+  hold();
+  read(ros::Time(0), ros::Duration(0));
+
+  registerInterfaces(arm_id, joint_names, model_);
+}
+
+SimulatedRobotHW::ControlMode SimulatedRobotHW::controlMode(const hardware_interface::ControllerInfo &info)
+{
+  for (const auto &resource : info.claimed_resources)
+  {
+    if (resource.hardware_interface == "hardware_interface::EffortJointInterface")
+      return ControlMode::kEffort;
+    if (resource.hardware_interface == "hardware_interface::PositionJointInterface")
+      return ControlMode::kPosition;
+    if (resource.hardware_interface == "hardware_interface::VelocityJointInterface")
+      return ControlMode::kVelocity;
+  }
+  return ControlMode::kNone;
+}
+
+bool SimulatedRobotHW::prepareSwitch(const std::list<hardware_interface::ControllerInfo> &start_list,
+                                     const std::list<hardware_interface::ControllerInfo> &stop_list)
+{
+  int joint_controllers = 0;
+  for (const auto &info : start_list)
+  {
+    if (controlMode(info) != ControlMode::kNone)
+      ++joint_controllers;
+  }
+  return joint_controllers <= 1;
+}
+
+void SimulatedRobotHW::doSwitch(const std::list<hardware_interface::ControllerInfo> &start_list,
+                                const std::list<hardware_interface::ControllerInfo> &stop_list)
+{
+  for (const auto &info : stop_list)
+  {
+    if (controlMode(info) == mode_)
+      mode_ = ControlMode::kNone;
+  }
+  for (const auto &info : start_list)
+  {
+    const ControlMode mode = controlMode(info);
+    if (mode != ControlMode::kNone)
+      mode_ = mode;
+  }
+  hold();
+}
+
+void SimulatedRobotHW::hold()
+{
+  effort_command_.fill(0.0);
+  velocity_command_.fill(0.0);
+  position_command_ = robot_state_.q;
+}
+
+void SimulatedRobotHW::read(const ros::Time &time, const ros::Duration &period)
+{
+  robot_state_.O_T_EE = model_.pose(franka::Frame::kEndEffector, robot_state_.q, robot_state_.F_T_EE,
+                                    robot_state_.EE_T_K);
+  robot_state_.O_T_EE_d = robot_state_.O_T_EE;
+  robot_state_.time = franka::Duration(static_cast<uint64_t>(time.toNSec() / 1000000));
+}
+
+void SimulatedRobotHW::write(const ros::Time &time, const ros::Duration &period)
+{
+  const std::array<double, 7> gravity =
+      model_.gravity(robot_state_.q, robot_state_.m_total, robot_state_.F_x_Ctotal, {{0.0, 0.0, -9.81}});
+
+  std::array<double, 7> tau_d;
+  for (size_t i = 0; i < 7; ++i)
+  {
+    const double q = robot_state_.q[i];
+    const double dq = robot_state_.dq[i];
+    switch (mode_)
+    {
+      case ControlMode::kEffort:
+        tau_d[i] = effort_command_[i];
+        break;
+      case ControlMode::kVelocity:
+        tau_d[i] = kDamping[i] * (velocity_command_[i] - dq);
+        break;
+      default:
+        tau_d[i] = kStiffness[i] * (position_command_[i] - q) - kDamping[i] * dq;
+        break;
+    }
+    tau_d[i] = std::max(-kTorqueLimit[i], std::min(kTorqueLimit[i], tau_d[i]));
+  }
+
+  std::array<double, 7> tau;
+  for (size_t i = 0; i < 7; ++i)
+    tau[i] = tau_d[i] + gravity[i] - kViscousFriction * robot_state_.dq[i];
+
+  // semi-implicit euler
+  const double dt = period.toSec();
+  const std::array<double, 7> ddq = model_.forwardDynamics(robot_state_.q, robot_state_.dq, tau);
+  for (size_t i = 0; i < 7; ++i)
+  {
+    robot_state_.dq[i] += ddq[i] * dt;
+    robot_state_.q[i] += robot_state_.dq[i] * dt;
+    robot_state_.tau_J[i] = tau_d[i] + gravity[i];
+    robot_state_.tau_J_d[i] = tau_d[i];
+  }
+  robot_state_.q_d = mode_ == ControlMode::kPosition ? position_command_ : robot_state_.q;
+  robot_state_.dq_d = mode_ == ControlMode::kVelocity ? velocity_command_ : robot_state_.dq;
+}
+
+}  // namespace advanced_robotics_franka_controllers
@@ -0,0 +1,124 @@
+#include <advanced_robotics_franka_controllers/telemetry_recorder.h>
+
+#include <chrono>
+#include <cstring>
+
+#include <ros/ros.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+namespace
+{
+const uint32_t kTelemetryVersion = 1;
+const size_t kRecordsPerWrite = 512;
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+  close();
+}
+
+int TelemetryRecorder::addChannel(const std::string &name, size_t fields)
+{
+  if (isOpen() || fields == 0 || fields > TelemetryRecord::kMaxFields)
+    return -1;
+  channels_.push_back({name, static_cast<uint32_t>(fields)});
+  return static_cast<int>(channels_.size()) - 1;
+}
+
+bool TelemetryRecorder::open(const std::string &file_name, size_t capacity)
+{
+  close();
+
+  file_ = fopen(file_name.c_str(), "wb");
+  if (file_ == nullptr)
+  {
+    ROS_ERROR_STREAM("TelemetryRecorder: Could not open " << file_name);
+    return false;
+  }
+
+  const uint32_t channel_count = channels_.size();
+  fwrite("ARFT", 1, 4, file_);
+  fwrite(&kTelemetryVersion, sizeof(uint32_t), 1, file_);
+  fwrite(&channel_count, sizeof(uint32_t), 1, file_);
+  for (const auto &channel : channels_)
+  {
+    const uint32_t name_length = channel.name.size();
+    fwrite(&channel.fields, sizeof(uint32_t), 1, file_);
+    fwrite(&name_length, sizeof(uint32_t), 1, file_);
+    fwrite(channel.name.data(), 1, name_length, file_);
+  }
+
+  queue_.reserve(capacity);
+  write_buffer_.resize(kRecordsPerWrite * (sizeof(uint32_t) + TelemetryRecord::kMaxFields * sizeof(double)));
+  dropped_.store(0, std::memory_order_relaxed);
+
+  running_.store(true, std::memory_order_release);
+  writer_ = std::thread(&TelemetryRecorder::writerLoop, this);
+  return true;
+}
+
+void TelemetryRecorder::close()
+{
+  if (!running_.exchange(false))
+    return;
+
+  writer_.join();
+  while (drain() > 0)
+  {
+  }
+  fclose(file_);
+  file_ = nullptr;
+
+  if (dropped_.load(std::memory_order_relaxed) > 0)
+    ROS_WARN_STREAM("TelemetryRecorder: " << dropped_.load() << " records were dropped");
+}
+
+bool TelemetryRecorder::recordArray(int channel, const double *data, size_t size)
+{
+  if (!running_.load(std::memory_order_acquire) || channel < 0 ||
+      channel >= static_cast<int>(channels_.size()) || size != channels_[channel].fields)
+    return false;
+
+  TelemetryRecord record;
+  record.channel = channel;
+  record.size = size;
+  std::memcpy(record.data, data, size * sizeof(double));
+
+  if (!queue_.push(record))
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void TelemetryRecorder::writerLoop()
+{
+  while (running_.load(std::memory_order_acquire))
+  {
+    if (drain() == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+size_t TelemetryRecorder::drain()
+{
+  TelemetryRecord record;
+  size_t count = 0;
+  char *cursor = write_buffer_.data();
+  while (count < kRecordsPerWrite && queue_.pop(record))
+  {
+    std::memcpy(cursor, &record.channel, sizeof(uint32_t));
+    cursor += sizeof(uint32_t);
+    std::memcpy(cursor, record.data, record.size * sizeof(double));
+    cursor += record.size * sizeof(double);
+    ++count;
+  }
+  if (count > 0)
+    fwrite(write_buffer_.data(), 1, cursor - write_buffer_.data(), file_);
+  return count;
+}
+
+}  // namespace advanced_robotics_franka_controllers
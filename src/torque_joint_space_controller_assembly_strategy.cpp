@@ -1,4 +1,6 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_assembly_strategy.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
+#include <advanced_robotics_franka_controllers/panda_kinematics.h>
 #include <cmath>
 #include <memory>
 
@@ -20,80 +22,17 @@ using namespace DyrosMath;
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerAssemblyStrategy::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerAssemblyStrategy::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   //joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");
   save_data_x = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_data_fm.txt","w");   
   save_data_x2 = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_data_pr.txt","w");   
 
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  assem = 0;
-
-
- gripper_ac_close.waitForServer();
-  gripper_ac_open.waitForServer();
-
-
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
-
-  current_pose_pub_ = node_handle.advertise<geometry_msgs::Pose>("/franka_states/current_pose",1);
-  current_twist_pub_ = node_handle.advertise<geometry_msgs::Twist>("/franka_states/current_twist",1);
-  current_wrench_pub_ = node_handle.advertise<geometry_msgs::Wrench>("/franka_states/current_wrench",1);
+  double state_publish_rate;
+  node_handle.param("state_publish_rate", state_publish_rate, 100.0);
+  current_pose_stream_.init(node_handle, "/franka_states/current_pose", state_publish_rate);
+  current_twist_stream_.init(node_handle, "/franka_states/current_twist", state_publish_rate);
+  current_wrench_stream_.init(node_handle, "/franka_states/current_wrench", state_publish_rate);
 
 
   planned_trajectory_ = node_handle.subscribe("/planned_arm_trajectory", 100, &TorqueJointSpaceControllerAssemblyStrategy::trajectoryCallback, this);
@@ -109,7 +48,10 @@ bool TorqueJointSpaceControllerAssemblyStrategy::init(hardware_interface::RobotH
 }
 
 void TorqueJointSpaceControllerAssemblyStrategy::starting(const ros::Time& time) {
+  gripper_.reset();
   //start_time_ = time;
+  // inputs from before the start are overwritten below
+  receiveCommands();
 	
   for (size_t i = 0; i < 7; ++i) {
     q_init_(i) = joint_handles_[i].getPosition();
@@ -181,29 +123,17 @@ void TorqueJointSpaceControllerAssemblyStrategy::starting(const ros::Time& time)
 }
 
 
-void TorqueJointSpaceControllerAssemblyStrategy::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array = model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-  
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
+void TorqueJointSpaceControllerAssemblyStrategy::updateController(const ros::Time& time, const ros::Duration& period) {
+  receiveCommands();
 
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
@@ -226,49 +156,60 @@ void TorqueJointSpaceControllerAssemblyStrategy::update(const ros::Time& time, c
   Eigen::Matrix<double, 3, 3> rotation_franka_;
   Eigen::Vector6d x_dot_(jacobian*qd);
   
-	rotation_franka_ = rotateWithZ(q(0))*rotateWithY(q(1))*rotateWithY(q(2))*rotateWithY(-q(3))*rotateWithY(q(4))*rotateWithY(-q(5))*rotateWithZ(-(q(6)))*rotateWithZ(-M_PI/4.0);
+  // franka hand frame from the joint angles, to compare with O_T_EE
+  const PandaKinematics kinematics(q);
+  rotation_franka_ = kinematics.flangeRotation() * rotateWithZ(-M_PI/4.0);
 
   Eigen::Vector3d angle_franka = DyrosMath::rot2Euler(rotation_franka_);
   Eigen::Vector3d angle_self_cal = DyrosMath::rot2Euler(rotation_M);
 
   //f_sensing = (jacobian * jacobian.transpose()).inverse() * jacobian * (tau_measured - gravity);
-  f_sensing = (jacobian * mass_matrix.inverse() * jacobian.transpose()).inverse() * jacobian * mass_matrix.inverse() * (tau_measured - gravity);
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
+  f_sensing = op_space.wrench(tau_measured - gravity);
 
   
   current_velocity_ = x_dot_;
   current_position_ = position;
-  Eigen::Quaterniond current_quat_(rotation_M);
-
 
-  current_pose_info_.position.x = current_position_(0);
-  current_pose_info_.position.y = current_position_(1);
-  current_pose_info_.position.z = current_position_(2);
-
-  current_pose_info_.orientation.x = current_quat_.x();
-  current_pose_info_.orientation.y = current_quat_.y();
-  current_pose_info_.orientation.z = current_quat_.z();
-  current_pose_info_.orientation.w = current_quat_.w();
+  if (geometry_msgs::Pose *pose = current_pose_stream_.tryAcquire(time))
+  {
+    Eigen::Quaterniond current_quat_(rotation_M);
 
-  current_twist_info_.linear.x = current_velocity_(0);
-  current_twist_info_.linear.y = current_velocity_(1);
-  current_twist_info_.linear.z = current_velocity_(2);
+    pose->position.x = current_position_(0);
+    pose->position.y = current_position_(1);
+    pose->position.z = current_position_(2);
 
-  current_twist_info_.angular.x = current_velocity_(3);
-  current_twist_info_.angular.y = current_velocity_(4);
-  current_twist_info_.angular.z = current_velocity_(5);
+    pose->orientation.x = current_quat_.x();
+    pose->orientation.y = current_quat_.y();
+    pose->orientation.z = current_quat_.z();
+    pose->orientation.w = current_quat_.w();
+    current_pose_stream_.publish(); //linear + angular
+  }
 
-  current_wrench_info_.force.x = f_sensing(0);
-  current_wrench_info_.force.y = f_sensing(1);
-  current_wrench_info_.force.z = f_sensing(2);
-  current_wrench_info_.torque.x = f_sensing(3);
-  current_wrench_info_.torque.y = f_sensing(4);
-  current_wrench_info_.torque.z = f_sensing(5);
+  if (geometry_msgs::Twist *twist = current_twist_stream_.tryAcquire(time))
+  {
+    twist->linear.x = current_velocity_(0);
+    twist->linear.y = current_velocity_(1);
+    twist->linear.z = current_velocity_(2);
+
+    twist->angular.x = current_velocity_(3);
+    twist->angular.y = current_velocity_(4);
+    twist->angular.z = current_velocity_(5);
+    current_twist_stream_.publish();
+  }
 
-  current_pose_pub_.publish(current_pose_info_); //linear + angular
-  current_twist_pub_.publish(current_twist_info_);
-  current_wrench_pub_.publish(current_wrench_info_);
+  if (geometry_msgs::Wrench *wrench = current_wrench_stream_.tryAcquire(time))
+  {
+    wrench->force.x = f_sensing(0);
+    wrench->force.y = f_sensing(1);
+    wrench->force.z = f_sensing(2);
+    wrench->torque.x = f_sensing(3);
+    wrench->torque.y = f_sensing(4);
+    wrench->torque.z = f_sensing(5);
+    current_wrench_stream_.publish();
+  }
 
-  ROS_INFO_STREAM("pos :" << q.transpose());
+  RT_LOG_INFO_THROTTLE(0.5, "pos :{}", q.transpose());
   // mode change -> q_traj 
 
 
@@ -345,22 +286,14 @@ void TorqueJointSpaceControllerAssemblyStrategy::update(const ros::Time& time, c
 
   if (gripper_close)
   {
-    epsilon.inner = 0.05;//0.005;
-    epsilon.outer = 0.05;//0.005;
-    close_goal.speed = 0.1;
-    close_goal.width = 0.005;//0.003;
-    close_goal.force = 100.0;
-    close_goal.epsilon = epsilon;
-    gripper_ac_close.sendGoal(close_goal);
+    gripper_.grasp(0.005, 0.1, 100.0, 0.05, 0.05);
     gripper_close = false;
 
   }
 
   if (gripper_open)
   {
-    open_goal.speed = 0.1;
-    open_goal.width = 0.08;
-    gripper_ac_open.sendGoal(open_goal);
+    gripper_.move(0.08, 0.1);
     gripper_open = false;
 
     // gripper_open = false;
@@ -384,52 +317,76 @@ void TorqueJointSpaceControllerAssemblyStrategy::update(const ros::Time& time, c
 
 void TorqueJointSpaceControllerAssemblyStrategy::commandForceCallback(const geometry_msgs::WrenchConstPtr& msg)
 {
-  f_star_zero_(0) = msg -> force.x;
-  f_star_zero_(1) = msg -> force.y;
-  f_star_zero_(2) = msg -> force.z;
-  f_star_zero_(3) = msg -> torque.x;
-  f_star_zero_(4) = msg -> torque.y;
-  f_star_zero_(5) = msg -> torque.z;
+  Eigen::Matrix<double, 6, 1> f_star_zero;
+  f_star_zero << msg -> force.x, msg -> force.y, msg -> force.z, msg -> torque.x, msg -> torque.y, msg -> torque.z;
+  f_star_zero_in_.write(f_star_zero);
 }
 
 void TorqueJointSpaceControllerAssemblyStrategy::pegInHoleStateCallback(const std_msgs::Int32ConstPtr& msg)
 {
-  peg_in_hole_state_ = msg -> data;
+  peg_in_hole_state_in_.write(msg -> data);
 }
 
 void TorqueJointSpaceControllerAssemblyStrategy::taskStartCallback(const std_msgs::Bool& msg)
 {
-  task_start_ = msg.data;
-  if (task_start_)
-    planned_done = false;
-  
+  task_start_in_.write(msg.data);
 }
 
 void TorqueJointSpaceControllerAssemblyStrategy::trajectoryCallback(const sensor_msgs::JointStateConstPtr& msg)
 {
-    for (size_t i = 0; i < msg->position.size(); i++)
+    if (msg->position.size() != 7)
     {
-        q_traj_[i] = msg->position[i];
+        ROS_WARN_THROTTLE(1.0, "TorqueJointSpaceControllerAssemblyStrategy: trajectory point needs 7 positions");
+        return;
     }
+    trajectory_in_.write(Eigen::Matrix<double, 7, 1>::Map(msg->position.data()));
 }
 
 
 void TorqueJointSpaceControllerAssemblyStrategy::planDoneCallback(const std_msgs::Bool& msg)
 {
-    planned_done = msg.data;
+    planned_done_in_.write(msg.data);
 }
 
 void TorqueJointSpaceControllerAssemblyStrategy::gripperCloseCallback(const std_msgs::Bool& msg)
 {
-    gripper_close = msg.data;
-    gripper_open = false;
+    gripper_close_in_.write(msg.data);
 }
 
 void TorqueJointSpaceControllerAssemblyStrategy::gripperOpenCallback(const std_msgs::Bool& msg)
 {
+    gripper_open_in_.write(msg.data);
+}
 
-    gripper_open = msg.data;
+void TorqueJointSpaceControllerAssemblyStrategy::receiveCommands()
+{
+  if (f_star_zero_in_.read())
+    f_star_zero_ = f_star_zero_in_.value();
+  if (peg_in_hole_state_in_.read())
+    peg_in_hole_state_ = peg_in_hole_state_in_.value();
+  if (trajectory_in_.read())
+    q_traj_ = trajectory_in_.value();
+  if (planned_done_in_.read())
+    planned_done = planned_done_in_.value();
+  if (task_start_in_.read())
+  {
+    task_start_ = task_start_in_.value();
+    if (task_start_)
+      planned_done = false;
+  }
+  // a new message is a new request, even if it repeats the last one
+  if (gripper_close_in_.read())
+  {
+    gripper_close = gripper_close_in_.value();
+    gripper_open = false;
+    gripper_.reset();
+  }
+  if (gripper_open_in_.read())
+  {
+    gripper_open = gripper_open_in_.value();
     gripper_close = false;
+    gripper_.reset();
+  }
 }
 
 
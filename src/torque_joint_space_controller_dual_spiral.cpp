@@ -1,4 +1,5 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_dual_spiral.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
 #include <cmath>
 #include <memory>
 
@@ -24,81 +25,27 @@ using namespace PegInHole;
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerDualSpiral::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerDualSpiral::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   //joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");
-  save_data_x = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE_spiral/save_data_x.txt","w");   
-  save_data_x2 = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE_spiral/save_data_x2.txt","w");   
-  force_moment_ee = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/force_moment_ee.txt","w");
-  cmd_task_space = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/cmd_task_space.txt","w");   
-  cmd_joint_space = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/cmd_joint_space.txt","w");
+  force_moment_channel_ = telemetry_.addChannel("LHS/force_moment_ee", 6);
+  position_channel_ = telemetry_.addChannel("LEE_spiral/save_data_x2", 6);
+  f_measured_channel_ = telemetry_.addChannel("LEE_spiral/save_data_x", 6);
+  cmd_task_space_channel_ = telemetry_.addChannel("LHS/cmd_task_space", 6);
+  cmd_joint_space_channel_ = telemetry_.addChannel("LHS/cmd_joint_space", 7);
+  std::string telemetry_file;
+  // relative paths land in the working directory of the node, $ROS_HOME by default
+  node_handle.param<std::string>("telemetry_file", telemetry_file, "dual_spiral.bin");
+  telemetry_.open(telemetry_file);
   //save_force = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_force.txt","w");   
   //save_position = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_position.txt","w");   
   //save_velocity = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_velocity.txt","w");   
   
-  gripper_ac_.waitForServer();
-
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
   return true;
 }
 
 void TorqueJointSpaceControllerDualSpiral::starting(const ros::Time& time) {
+  gripper_.reset();
   start_time_ = time;
 	
   for (size_t i = 0; i < 7; ++i) {
@@ -197,36 +144,21 @@ void TorqueJointSpaceControllerDualSpiral::starting(const ros::Time& time) {
   T_EA_ = T_GA_;
 
   assembly_dir_vec_ = PegInHole2::getAssemblyDirction(T_GA_);
-  std::cout<<"T_GA: \n"<<T_GA_<<std::endl;
-  std::cout<<"assembly_dir_vec_: "<<assembly_dir_vec_.transpose()<<std::endl;
+  RT_LOG_INFO("T_GA: \n{}", T_GA_);
+  RT_LOG_INFO("assembly_dir_vec_: {}", assembly_dir_vec_.transpose());
 
 }
 
 
-void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void TorqueJointSpaceControllerDualSpiral::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
@@ -262,15 +194,12 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
 
   Eigen::Vector6d xd;
   Eigen::Matrix<double, 6, 1> f_star_zero;
-  Eigen::Matrix<double, 6, 6> lambda;
-  Eigen::Matrix<double, 7, 6> J_bar;
   Eigen::Matrix<double, 6, 1> f_measured;
   Eigen::Vector3d force_ee; //w.r.t end-effector
   Eigen::Vector3d moment_ee; 
   
-  lambda = (jacobian*mass_matrix.inverse()*jacobian.transpose()).inverse();
-  J_bar = mass_matrix.inverse()*jacobian.transpose()*lambda;
-  f_measured = J_bar.transpose()*(tau_measured - gravity); //w.r.t global frame
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
+  f_measured = op_space.wrench(tau_measured - gravity); //w.r.t global frame
 
   force_ee = rotation_M.transpose()*f_measured.head<3>();
   moment_ee = rotation_M.transpose()*f_measured.tail<3>();
@@ -280,6 +209,7 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
   xd = jacobian*qd;
   
   cur_time_ = time;
+  cur_period_ = period;
 ///////////////////////////////////////////////
 
   // franka_gripper::MoveGoal goal;
@@ -309,8 +239,8 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
       {
         status_ = 1;
         is_approach_done_ = true;
-        std::cout<<force_ee(assembly_dir_ee_)<<std::endl;
-        std::cout<<"CONTACT IS DETECT!!"<<std::endl;
+        RT_LOG_INFO("{}", force_ee(assembly_dir_ee_));
+        RT_LOG_INFO("CONTACT IS DETECT!!");
       } 
       break;
     case 1:
@@ -319,7 +249,7 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
       {
         status_ = 2;
         is_search_done_ = true;
-        std::cout<<"Hole IS DETECTED"<<std::endl;
+        RT_LOG_INFO("Hole IS DETECTED");
       }
       break;
     case 2:
@@ -328,7 +258,7 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
       {
         status_ = 3;
         is_insert_done_ = true;
-        std::cout<<"INSERTION IS DONE"<<std::endl;
+        RT_LOG_INFO("INSERTION IS DONE");
       }
       break;
     case 3:
@@ -336,12 +266,15 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
       if(is_release_done_)
       {
         status_ = 4;
-        std::cout<<"READY TO OPEN A GRIPPER"<<std::endl;
+        RT_LOG_INFO("READY TO OPEN A GRIPPER");
+        gripperOpen();
       } 
       break;   
     
     case 4:
-      gripperOpen();
+      // the move was sent on entry; send it again only if it failed
+      if (gripper_.state() == GripperDispatcher::State::kFailed)
+        gripperOpen();
       break;
 
   }
@@ -372,11 +305,11 @@ void TorqueJointSpaceControllerDualSpiral::update(const ros::Time& time, const r
     //joint_handles_[i].setCommand(0);
   }
 
-  fprintf(force_moment_ee, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", force_ee(0), force_ee(1), force_ee(2), moment_ee(0), moment_ee(1), moment_ee(2));
-  fprintf(save_data_x2, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", position(0), position(1), position(2), x_dot_(0), x_dot_(1), x_dot_(2));
-  fprintf(save_data_x, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", f_measured(0), f_measured(1), f_measured(2), f_measured(3), f_measured(4), f_measured(5));
-  fprintf(cmd_task_space, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", f_star_zero_(0), f_star_zero_(1), f_star_zero_(2), f_star_zero_(3), f_star_zero_(4), f_star_zero_(5));
-  fprintf(cmd_joint_space, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", tau_cmd(0), tau_cmd(1), tau_cmd(2), tau_cmd(3), tau_cmd(4), tau_cmd(5), tau_cmd(6));
+  telemetry_.record(force_moment_channel_, force_ee(0), force_ee(1), force_ee(2), moment_ee(0), moment_ee(1), moment_ee(2));
+  telemetry_.record(position_channel_, position(0), position(1), position(2), x_dot_(0), x_dot_(1), x_dot_(2));
+  telemetry_.recordArray(f_measured_channel_, f_measured.data(), 6);
+  telemetry_.recordArray(cmd_task_space_channel_, f_star_zero_.data(), 6);
+  telemetry_.recordArray(cmd_joint_space_channel_, tau_cmd.data(), 7);
 
 }
 
@@ -391,7 +324,7 @@ void TorqueJointSpaceControllerDualSpiral::approach(Eigen::Vector3d position, Ei
     ori_init_ = rotation;
 
     is_approach_first_ = false;
-    std::cout<<"approach first"<<std::endl;
+    RT_LOG_INFO("approach first");
   }
   
    //Be ee frame!!!
@@ -420,68 +353,20 @@ void TorqueJointSpaceControllerDualSpiral::search(const Eigen::Vector3d position
     pos_init_ = position;
     ori_init_ = rotation;
 
-    spiral_start_time_ = cur_time_;
+    spiral_.reset(Eigen::Vector2d::Zero(), lin_v, pitch, duration);
+    // +-3 deg about the assembly axis, one swing every ori_duration
+    wiggle_.reset(3*M_PI/180, 0.5 / ori_duration, cur_period_.toSec());
 
     is_search_first_ = false;
-    std::cout<<"search first"<<std::endl;
+    RT_LOG_INFO("search first");
   }
 
-  // f_star = generateSpiral(pos_init_, position, xd, pitch, lin_v, assembly_dir_, cur_time_.toSec(), spiral_start_time_.toSec(), duration);
-  f_star = PegInHole2::generateSpiralEE(pos_init_, ori_init_, position, xd, pitch, lin_v, T_EA_, cur_time_.toSec(), spiral_start_time_.toSec(), duration);
+  // f_star = generateSpiral(pos_init_, position, xd, assembly_dir_, spiral_.advance(cur_period_.toSec()));
+  f_star = PegInHole2::generateSpiralEE(pos_init_, ori_init_, position, xd, T_EA_, spiral_.advance(cur_period_.toSec()));
   f_star(assembly_dir_) = -1.0;
   // f_star += PegInHole2::press(ori_init_, assembly_dir_vec_, 1.0);
 
-  if (ori_change_dir_ == 0)
-  {
-    if (is_first_ == true)
-    {
-      ori_start_time_ = cur_time_;
-      is_first_ = false;
-      // ori_init_ = desired_rotation_M;
-    }  
-
-    m_star = generateSpiralWithRotation(ori_init_, rotation, xd.tail<3>(), cur_time_.toSec(), ori_start_time_.toSec(), ori_duration, ori_change_dir_, assembly_dir_, 3*M_PI/180);
-
-    if (cur_time_.toSec() > ori_start_time_.toSec() + ori_duration / 2)
-    {
-      ori_change_dir_ = 1;
-      is_first_ = true;
-    }
-  }
-
-  if (ori_change_dir_ == 1)
-  {
-    if (is_first_ == true)
-    {
-      ori_start_time_ = cur_time_;
-      is_first_ = false;
-    }
-    
-    m_star = generateSpiralWithRotation(ori_init_, rotation, xd.tail<3>(), cur_time_.toSec(), ori_start_time_.toSec(), ori_duration, ori_change_dir_, assembly_dir_, 3*M_PI/180);
-
-    if (cur_time_.toSec() > ori_start_time_.toSec() + ori_duration)
-    {
-      ori_change_dir_ = 2;
-      is_first_ = true;
-    }
-  }
-
-  if (ori_change_dir_ == 2)
-  {
-    if (is_first_ == true)
-    {
-      ori_start_time_ = cur_time_;
-      is_first_ = false;
-    }
-
-    m_star = generateSpiralWithRotation(ori_init_, rotation, xd.tail<3>(), cur_time_.toSec(), ori_start_time_.toSec(), ori_duration, ori_change_dir_, assembly_dir_, 3*M_PI/180);
-
-    if (cur_time_.toSec() > ori_start_time_.toSec() + ori_duration)
-    {
-      ori_change_dir_ = 1;
-      is_first_ = true;
-    }
-  }
+  m_star = generateRotation(ori_init_, rotation, xd.tail<3>(), assembly_dir_, wiggle_.advance());
 
   f_star_zero_.head<3>() = f_star;
   f_star_zero_.tail<3>() = m_star;
@@ -491,7 +376,6 @@ void TorqueJointSpaceControllerDualSpiral::insert(const Eigen::Vector3d position
 {
   Eigen::Vector3d f_star;
   Eigen::Vector3d m_star;
-  double ori_duration = 1.0;
 
   if(is_insert_first_)
   {
@@ -501,63 +385,14 @@ void TorqueJointSpaceControllerDualSpiral::insert(const Eigen::Vector3d position
     insert_start_time_ = cur_time_;
 
     is_insert_first_ = false;
-    std::cout<<"insert first"<<std::endl;
+    RT_LOG_INFO("insert first");
   }
 
   f_star = keepCurrentState(pos_init_, ori_init_, position, rotation, xd, 5000, 100).head<3>();
   f_star(assembly_dir_) = -10.0;
   
-  if (ori_change_dir_ == 0)
-  {
-    if (is_first_ == true)
-    {
-      ori_start_time_ = cur_time_;
-      is_first_ = false;
-      // ori_init_ = desired_rotation_M;
-    }  
-
-    m_star = generateSpiralWithRotation(ori_init_, rotation, xd.tail<3>(), cur_time_.toSec(), ori_start_time_.toSec(), ori_duration, ori_change_dir_, assembly_dir_, 0*M_PI/180);
-
-    if (cur_time_.toSec() > ori_start_time_.toSec() + ori_duration / 2)
-    {
-      ori_change_dir_ = 1;
-      is_first_ = true;
-    }
-  }
-
-  if (ori_change_dir_ == 1)
-  {
-    if (is_first_ == true)
-    {
-      ori_start_time_ = cur_time_;
-      is_first_ = false;
-    }
-    
-    m_star = generateSpiralWithRotation(ori_init_, rotation, xd.tail<3>(), cur_time_.toSec(), ori_start_time_.toSec(), ori_duration, ori_change_dir_, assembly_dir_, 0*M_PI/180);
-
-    if (cur_time_.toSec() > ori_start_time_.toSec() + ori_duration)
-    {
-      ori_change_dir_ = 2;
-      is_first_ = true;
-    }
-  }
-
-  if (ori_change_dir_ == 2)
-  {
-    if (is_first_ == true)
-    {
-      ori_start_time_ = cur_time_;
-      is_first_ = false;
-    }
-
-    m_star = generateSpiralWithRotation(ori_init_, rotation, xd.tail<3>(), cur_time_.toSec(), ori_start_time_.toSec(), ori_duration, ori_change_dir_, assembly_dir_, 0*M_PI/180);
-
-    if (cur_time_.toSec() > ori_start_time_.toSec() + ori_duration)
-    {
-      ori_change_dir_ = 1;
-      is_first_ = true;
-    }
-  }
+  // no wiggle while inserting, hold the orientation it started with
+  m_star = generateRotation(ori_init_, rotation, xd.tail<3>(), assembly_dir_, 0.0);
 
   //m_star.setZero();
   f_star_zero_.head<3>() = f_star;
@@ -588,16 +423,16 @@ void TorqueJointSpaceControllerDualSpiral::release(Eigen::Vector3d position, Eig
     release_start_time_.toSec() + duration;
 
     is_release_first_ = false;
-    std::cout<<"init_force_: "<<init_force_.transpose()<<std::endl;
-    std::cout<<"release first"<<std::endl;
+    RT_LOG_INFO("init_force_: {}", init_force_.transpose());
+    RT_LOG_INFO("release first");
   }
 
   if(cur_time_.toSec() - release_start_time_.toSec() > duration)
   {
     is_release_done_ = true;
     is_release_first_ = true;
-    std::cout<<cur_time_.toSec() - release_start_time_.toSec()<<std::endl;
-    std::cout<<"RELEASE IS DONE, GO TO THE NEXT STEP"<<std::endl;
+    RT_LOG_INFO("{}", cur_time_.toSec() - release_start_time_.toSec());
+    RT_LOG_INFO("RELEASE IS DONE, GO TO THE NEXT STEP");
 
   } 
 
@@ -614,10 +449,7 @@ void TorqueJointSpaceControllerDualSpiral::release(Eigen::Vector3d position, Eig
 
 void TorqueJointSpaceControllerDualSpiral::gripperOpen()
 {
-  franka_gripper::MoveGoal goal;
-  goal.speed = 0.015;
-  goal.width = 0.1;
-  gripper_ac_.sendGoal(goal);
+  gripper_.move(0.1, 0.015);
 }
 
 } // namespace advanced_robotics_franka_controllers
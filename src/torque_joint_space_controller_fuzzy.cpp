@@ -1,4 +1,5 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_fuzzy.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -27,7 +28,7 @@ using namespace PegInHole;
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerFuzzy::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerFuzzy::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   gripper_ac_close_.waitForServer();
   gripper_ac_open_.waitForServer();
@@ -35,64 +36,6 @@ bool TorqueJointSpaceControllerFuzzy::init(hardware_interface::RobotHW* robot_hw
   //joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");
   fuzzy_io = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/ur/fuzzy_io.txt","w");
 
-  std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
-
   Eigen::Vector3d sgn;
   srand((unsigned int)time(NULL));
   for(size_t i = 0; i < 3; i++)
@@ -174,29 +117,15 @@ void TorqueJointSpaceControllerFuzzy::starting(const ros::Time& time) {
 }
 
 
-void TorqueJointSpaceControllerFuzzy::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array = model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void TorqueJointSpaceControllerFuzzy::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
@@ -222,15 +151,12 @@ void TorqueJointSpaceControllerFuzzy::update(const ros::Time& time, const ros::D
 
   jacobian_pos_ = jacobian.block(0, 0, 3, 7);
   Eigen::Vector6d xd;
-  Eigen::Matrix<double, 6, 6> lambda;
-  Eigen::Matrix<double, 7, 6> J_bar;
   Eigen::Matrix<double, 6, 1> f_measured;
   Eigen::Vector3d force_ee; //w.r.t end-effector
   Eigen::Vector3d moment_ee; 
   
-  lambda = (jacobian*mass_matrix.inverse()*jacobian.transpose()).inverse();
-  J_bar = mass_matrix.inverse()*jacobian.transpose()*lambda;
-  f_measured = J_bar.transpose()*(tau_measured - gravity); //w.r.t global frame
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
+  f_measured = op_space.wrench(tau_measured - gravity); //w.r.t global frame
 
   force_ee = rotation_M.transpose()*f_measured.head<3>();
   moment_ee = rotation_M.transpose()*f_measured.tail<3>();
@@ -247,6 +173,7 @@ void TorqueJointSpaceControllerFuzzy::update(const ros::Time& time, const ros::D
   f = sqrt(f);
   
   cur_time_ = time;
+  cur_period_ = period;
   
   
 ///////////////////////////////////////////////
@@ -483,12 +410,13 @@ void TorqueJointSpaceControllerFuzzy::search(const Eigen::Vector3d position, con
     ori_init_ = rotation;
 
     spiral_start_time_ = cur_time_;
+    spiral_.reset(Eigen::Vector2d::Zero(), lin_v, pitch, duration);
 
     is_search_first_ = false;
     std::cout<<"start search"<<std::endl;
   }
 
-  f_star = generateSpiral(pos_init_, position, xd, pitch, lin_v, assembly_dir_, cur_time_.toSec(), spiral_start_time_.toSec(), duration);
+  f_star = generateSpiral(pos_init_, position, xd, assembly_dir_, spiral_.advance(cur_period_.toSec()));
   f_star(assembly_dir_) = -6.0;
   
   m_star = keepOrientationPerpenticular(ori_init_, rotation, xd, 1.0, cur_time_.toSec(), spiral_start_time_.toSec());
@@ -1,4 +1,5 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_hip.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
 #include <cmath>
 #include <memory>
 
@@ -20,71 +21,13 @@ using namespace DyrosMath;
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerHip::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerHip::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");  
   force_moment_ee = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/force_moment_ee.txt","w");
   vel_ang_ee = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/vel_ang_ee.txt","w");
   force_select = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/force_select.txt","w");
   pos_ee = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/pos_ee.txt","w");
-
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
   return true;
 }
 
@@ -94,6 +37,10 @@ void TorqueJointSpaceControllerHip::starting(const ros::Time& time) {
   for (size_t i = 0; i < 7; ++i) {
     q_init_(i) = joint_handles_[i].getPosition();
   }
+
+  Eigen::Matrix<double, 7, 1> q_goal;
+  q_goal << 0, 0.0, 0.0, -M_PI/2, 0, M_PI/2, 0;
+  homing_ = MultiCubicSegment<7>(start_time_.toSec(), start_time_.toSec() + 5.0, q_init_, q_goal);
   
   const franka::RobotState &robot_state = state_handle_->getRobotState();
   transform_init_ = Eigen::Matrix4d::Map(robot_state.O_T_EE.data());
@@ -106,46 +53,28 @@ void TorqueJointSpaceControllerHip::starting(const ros::Time& time) {
 
   status_ = 0;
   goal_position_.setZero();
-  std::cout<<"START POSITION: "<<pos_init_.transpose()<<std::endl;
+  RT_LOG_INFO("START POSITION: {}", pos_init_.transpose());
 }
 
 
-void TorqueJointSpaceControllerHip::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void TorqueJointSpaceControllerHip::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
-  Eigen::Matrix<double , 7, 1> q_goal;
   Eigen::Matrix<double , 7, 1> q_desired;
   Eigen::Matrix<double , 7, 1> qd_desired;
   Eigen::Matrix<double , 12, 1> x_goal; 
   Eigen::Matrix<double , 12, 1> x_desired;
   Eigen::Matrix<double , 12, 1> x_current;
   
-  q_goal.setZero();
-  q_goal << 0, 0.0, 0.0, -M_PI/2, 0, M_PI/2, 0;
   q_desired.setZero();
 
   ros::Duration simulation_time = time - start_time_;
@@ -156,14 +85,9 @@ void TorqueJointSpaceControllerHip::update(const ros::Time& time, const ros::Dur
   Eigen::Vector3d position(transform.translation());
   Eigen::Matrix<double, 3, 3> rotation_M(transform.rotation());
 
-  double trajectory_time = 5.0;
-  for(int i=0; i<7;i++)
-  {
-    q_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-                                        q_init_(i), q_goal(i), 0, 0);
-    qd_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-                                        q_init_(i), q_goal(i), 0, 0);
-  }
+  const MultiTrajectoryPoint<7> desired = homing_.evaluate(time.toSec());
+  q_desired = desired.position;
+  qd_desired = desired.velocity;
 
 
   qd_desired.setZero();
@@ -171,14 +95,11 @@ void TorqueJointSpaceControllerHip::update(const ros::Time& time, const ros::Dur
 //---------------------------------code starts from here--------------------------
   Eigen::Vector6d xd;
   Eigen::Matrix<double, 6, 1> f_star_zero;
-  Eigen::Matrix<double, 6, 6> lambda;
-  Eigen::Matrix<double, 7, 6> J_bar;
   Eigen::Vector3d force_ee; //w.r.t end-effector
   Eigen::Vector3d moment_ee; 
   
-  lambda = (jacobian*mass_matrix.inverse()*jacobian.transpose()).inverse();
-  J_bar = mass_matrix.inverse()*jacobian.transpose()*lambda;
-  f_measured_ = J_bar.transpose()*(tau_measured - gravity); //w.r.t global frame
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
+  f_measured_ = op_space.wrench(tau_measured - gravity); //w.r.t global frame
 
   force_ee = rotation_M.transpose()*f_measured_.head<3>();
   moment_ee = rotation_M.transpose()*f_measured_.tail<3>();
@@ -196,7 +117,7 @@ void TorqueJointSpaceControllerHip::update(const ros::Time& time, const ros::Dur
       if(checkForceDot(fx_ee_, 8.0))
       {
         status_ = 1;
-        std::cout<<"CONTACT IS DETECT!!"<<std::endl;
+        RT_LOG_INFO("CONTACT IS DETECT!!");
       } 
       break;
     case 1:
@@ -232,8 +153,8 @@ void TorqueJointSpaceControllerHip::update(const ros::Time& time, const ros::Dur
 
   if(data_save_trigger_())
   {    
-    fx_ee_.push_back(force_ee(0));
-    fprintf(force_select, "%lf\t\n", fx_ee_.back());
+    fx_ee_.push(force_ee(0));
+    fprintf(force_select, "%lf\t\n", fx_ee_.last());
   }
 
     fprintf(force_moment_ee, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", force_ee(0), force_ee(1), force_ee(2), moment_ee(0), moment_ee(1), moment_ee(2));
@@ -292,13 +213,13 @@ void TorqueJointSpaceControllerHip::rasterSearch(Eigen::Vector3d x, Eigen::Matri
     search_start_time_ = cur_time_;    
     is_first_ = false;
 
-    std::cout<<"sgn_: "<<sgn_<<std::endl;
-    std::cout<<"distance: "<<range_<<std::endl;
-    std::cout<<"cnt: "<<cnt_<<std::endl;
-    std::cout<<"duration: "<<duration_<<std::endl;
-    std::cout<<"start_position: "<<pos_init_.transpose()<<std::endl;
-    std::cout<<"goal_position_: "<<goal_position_.transpose()<<std::endl;
-    std::cout<<"--------------------------------"<<std::endl;
+    RT_LOG_INFO("sgn_: {}", sgn_);
+    RT_LOG_INFO("distance: {}", range_);
+    RT_LOG_INFO("cnt: {}", cnt_);
+    RT_LOG_INFO("duration: {}", duration_);
+    RT_LOG_INFO("start_position: {}", pos_init_.transpose());
+    RT_LOG_INFO("goal_position_: {}", goal_position_.transpose());
+    RT_LOG_INFO("--------------------------------");
 
   }
 
@@ -325,7 +246,7 @@ void TorqueJointSpaceControllerHip::rasterSearch(Eigen::Vector3d x, Eigen::Matri
   if(x(assemble_dir_) - pos_init_(assemble_dir_) >= 0.002)
   {
     status_ = 2;
-    std::cout<<"Raster search is done"<<std::endl;
+    RT_LOG_INFO("Raster search is done");
   }
 
   f_star_zero_.head<3>() = f_star;
@@ -379,8 +300,6 @@ void TorqueJointSpaceControllerHip::insert(double current_force, double threshol
   f_star = keepCurrentState(pos_init_, ori_init_, x, ori, xd, 5000, 100).head<3>();
   m_star.setZero();
 
-  std::cout<<"f_star: "<<f_star.transpose()<<std::endl;
-  
   Eigen::Vector3d temp = ori_init_*push;
   f_star(assemble_dir_) = temp(assemble_dir_);
 
@@ -391,16 +310,13 @@ void TorqueJointSpaceControllerHip::insert(double current_force, double threshol
   
 
 
-  std::cout<<"f_star: "<<f_star.transpose()<<std::endl;
-  std::cout<<"m_star: "<<m_star.transpose()<<std::endl;
-  std::cout<<"push_ee: "<<push.transpose()<<std::endl;
-  std::cout<<"push_ee: "<<temp.transpose()<<std::endl;
-  std::cout<<"-----------------"<<std::endl;
+  RT_LOG_INFO_THROTTLE(0.5, "f_star: {}\nm_star: {}\npush_ee: {}\npush_ee: {}\n-----------------",
+                       f_star.transpose(), m_star.transpose(), push.transpose(), temp.transpose());
   
   if( cur_time_.toSec() - insert_start_time_.toSec() >= 3.0)
   {
     status_ = 3;
-    std::cout<<"INSERTION IS DONE"<<std::endl;
+    RT_LOG_INFO("INSERTION IS DONE");
   }
 
   // f_star_zero_.setZero();
@@ -412,15 +328,13 @@ Eigen::Vector3d TorqueJointSpaceControllerHip::forceSmoothing(const Eigen::Vecto
 
   double current_time = tick / 1000;
 
-  std::cout<<current_time<<std::endl;
-
   for(size_t i = 0; i < 3; i ++)
   {
     cmd(i) = cubic(current_time, 0.0, duration, start_force(i), target_force(i), 0, 0);
-    
-    std::cout<<i<<" value: "<<cmd(i)<<std::endl;
   }
 
+  RT_LOG_INFO_THROTTLE(0.5, "{} value: {}", current_time, cmd.transpose());
+
   return cmd;
 }
 
@@ -446,9 +360,8 @@ void TorqueJointSpaceControllerHip::verify(const Eigen::Vector3d force_ee, const
   // f_star_zero_.head<3>() = f_star;
   // f_star_zero_.tail<3>() = m_star;
 
-  std::cout<<"check direction: "<<check_assembly_.transpose()<<std::endl;
-  std::cout<<"check force_ee: "<<force_ee.transpose()<<std::endl;
-  std::cout<<"-------------------------"<<std::endl;
+  RT_LOG_INFO_THROTTLE(0.5, "check direction: {}\ncheck force_ee: {}\n-------------------------",
+                       check_assembly_.transpose(), force_ee.transpose());
 }
 
 
@@ -1,4 +1,5 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_joint_test.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
 #include <cmath>
 #include <memory>
 
@@ -23,7 +24,7 @@ using namespace DyrosMath;
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerJointTest::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerJointTest::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");  
   pr_real = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/pr_real.txt","w");   
@@ -31,68 +32,11 @@ bool TorqueJointSpaceControllerJointTest::init(hardware_interface::RobotHW* robo
   fm_cmd = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/fm_cmd.txt","w");     
   torque_cmd = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/torque_cmd.txt","w");     
   spiral_position = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/spiral_position.txt","w");     
-	
-  std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
   return true;
 }
 
 void TorqueJointSpaceControllerJointTest::starting(const ros::Time& time) {
+  gripper_.reset();
   start_time_ = time;
 	
   for (size_t i = 0; i < 7; ++i) {
@@ -145,8 +89,8 @@ void TorqueJointSpaceControllerJointTest::starting(const ros::Time& time) {
   // grasp_frame_ = PegInHole2::setTransformation(grasp_pos_, grasp_quat_);
   grasp_frame_ = PegInHole2::setTransformation(grasp_pos_, grasp_rot_);
 
-  std::cout<<"assembly_frame_: \n"<<assembly_frame_<<std::endl;
-  std::cout<<"grasp_frame_: \n"<<grasp_frame_<<std::endl;
+  RT_LOG_INFO("assembly_frame_: \n{}", assembly_frame_);
+  RT_LOG_INFO("grasp_frame_: \n{}", grasp_frame_);
 
   f_ee_prev_.setZero();
   m_ee_prev_.setZero();
@@ -157,30 +101,15 @@ void TorqueJointSpaceControllerJointTest::starting(const ros::Time& time) {
 }
 
 
-void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void TorqueJointSpaceControllerJointTest::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
@@ -224,17 +153,14 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
   // qd_desired.setZero();
 
 //--------------------------code start frome here------------------------------------------
-  Eigen::Matrix<double, 6, 6> lambda;
-  Eigen::Matrix<double, 7, 6> J_bar;
   Eigen::Matrix<double, 6, 1> f_measured;
   Eigen::Vector3d force_ee; //w.r.t end-effector
   Eigen::Vector3d moment_ee; 
   Eigen::Matrix<double, 6, 1> xd;
   double f_reaction;
 
-  lambda = (jacobian*mass_matrix.inverse()*jacobian.transpose()).inverse();
-  J_bar = mass_matrix.inverse()*jacobian.transpose()*lambda;
-  f_measured = J_bar.transpose()*(tau_measured - gravity); //w.r.t global frame
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
+  f_measured = op_space.wrench(tau_measured - gravity); //w.r.t global frame
 
   force_ee = rotation_M.transpose()*f_measured.head<3>();
   moment_ee = rotation_M.transpose()*f_measured.tail<3>();
@@ -247,6 +173,7 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
   xd = jacobian*qd;
 
   cur_time_ = time;
+  cur_period_ = period;
 
   double approach_threshold = 0.0;
     
@@ -260,7 +187,9 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
 
   f_reaction = sqrt(f_reaction); 
   
-  gripperClose();
+  // starting() sent the grasp; send it again only if it failed
+  if (gripper_.state() == GripperDispatcher::State::kFailed)
+    gripperClose();
 
 
 
@@ -280,7 +209,7 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
         if(timeOut(cur_time_.toSec(), tilt_start_time_.toSec(), tilt_duration_))
         {
           state_ = MOVEBACK;
-          std::cout<<"TILT IS DONE"<<std::endl;
+          RT_LOG_INFO("TILT IS DONE");
         }
         break;
 
@@ -289,7 +218,7 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
         if(timeOut(cur_time_.toSec(), moveback_start_time_.toSec(), moveback_duration_))
         {
           state_ = APPROACH;
-          std::cout<<"MOVEBACK IS DONE"<<std::endl;
+          RT_LOG_INFO("MOVEBACK IS DONE");
         }
         break;
 
@@ -302,9 +231,9 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
           if(getCount(contact_check_cnt_, 50))
           {
             state_ = SEARCH;
-            std::cout<<"CONTACT IS DETECT!!"<<std::endl;
-            std::cout<<"force_ee: "<<force_ee(assembly_dir_)<<std::endl;
-            std::cout<<"threshold: "<<approach_threshold<<std::endl;
+            RT_LOG_INFO("CONTACT IS DETECT!!");
+            RT_LOG_INFO("force_ee: {}", force_ee(assembly_dir_));
+            RT_LOG_INFO("threshold: {}", approach_threshold);
             contact_check_cnt_ = 0;
           }
           
@@ -316,8 +245,8 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
         if(checkForceLimit(f_reaction, 10.0))
         {
           state_ = INSERT;
-          std::cout<<"f_reaction: "<<f_reaction<<std::endl;
-          std::cout<<"SEARCH IS COMPLETED!!"<<std::endl;
+          RT_LOG_INFO("f_reaction: {}", f_reaction);
+          RT_LOG_INFO("SEARCH IS COMPLETED!!");
         }
         break;
 
@@ -326,7 +255,7 @@ void TorqueJointSpaceControllerJointTest::update(const ros::Time& time, const ro
         if(timeOut(cur_time_.toSec(), insert_start_time_.toSec(), 5.0))
         {
           state_ = RELEASE;
-          std::cout<<"INSERTION IS DONE"<<std::endl;
+          RT_LOG_INFO("INSERTION IS DONE");
         }
         break;
 
@@ -390,12 +319,12 @@ void TorqueJointSpaceControllerJointTest::ready(const Eigen::Vector3d position,
     assembly_dir_vec_ = PegInHole2::getAssemblyDirction(T_GA_);
     set_tilt_ = PegInHole2::setTilt(T_GA_, assembly_dir_vec_, 0.01);
     tilt_axis_ = PegInHole2::getTiltDirection(T_GA_, assembly_dir_vec_);
-    std::cout<<"T_GA: \n"<<T_GA_<<std::endl;
-    std::cout<<"assembly_dir_: "<<assembly_dir_vec_.transpose()<<std::endl;
+    RT_LOG_INFO("T_GA: \n{}", T_GA_);
+    RT_LOG_INFO("assembly_dir_: {}", assembly_dir_vec_.transpose());
     // std::cout<<"set_tilt: "<<set_tilt_<<std::endl;
-    std::cout<<"tilt_axis_!!!!!!!: "<<tilt_axis_.transpose()<<std::endl;
-    std::cout<<"ori_init: \n"<<ori_init_<<std::endl;
-    std::cout<<"ready"<<std::endl;
+    RT_LOG_INFO("tilt_axis_!!!!!!!: {}", tilt_axis_.transpose());
+    RT_LOG_INFO("ori_init: \n{}", ori_init_);
+    RT_LOG_INFO("ready");
   }
 
   run_time = cur_time_.toSec() - start_time_.toSec();
@@ -446,7 +375,7 @@ void TorqueJointSpaceControllerJointTest::tilt(const Eigen::Vector3d position, c
     ori_init_ = rotation;
     tilt_start_time_ = cur_time_;
     is_tilt_first_ = false;
-    std::cout<<"tilt"<<std::endl;
+    RT_LOG_INFO("tilt");
   }
 
   
@@ -468,7 +397,7 @@ void TorqueJointSpaceControllerJointTest::moveback(Eigen::Vector3d position, Eig
     ori_init_ = rotation;
     moveback_start_time_ = cur_time_;
     is_moveback_first_ = false;
-    std::cout<<"move back"<<std::endl;
+    RT_LOG_INFO("move back");
 
   }
 
@@ -492,7 +421,7 @@ void TorqueJointSpaceControllerJointTest::approach(Eigen::Vector3d position, Eig
     search_pose_rotation_ = rotation;
     approach_start_time_ = cur_time_;
     is_approach_first_ = false;
-    std::cout<<"start approach"<<std::endl;
+    RT_LOG_INFO("start approach");
   }
   
   
@@ -520,12 +449,13 @@ void TorqueJointSpaceControllerJointTest::search(const Eigen::Vector3d position,
   {
     pos_init_ = position;
     ori_init_ = rotation;
-    spiral_start_time_ = cur_time_;
+    spiral_.reset(Eigen::Vector2d::Zero(), lin_v, pitch, duration);
+    spiral_.scale(0.8, 1.0);
     is_search_first_ = false;
-    std::cout<<"start search"<<std::endl;
+    RT_LOG_INFO("start search");
   }
 
-  f_star = generateEllipseSpiralEE(pos_init_, position, xd, ori_init_, pitch, lin_v, assembly_dir_, cur_time_.toSec(), spiral_start_time_.toSec(), duration, 0.8, 1.0);
+  f_star = generateEllipseSpiralEE(pos_init_, position, xd, ori_init_, assembly_dir_, spiral_.advance(cur_period_.toSec()));
   Eigen::Vector3d temp = ori_init_*f_asm_;
   f_star(assembly_dir_) += temp(assembly_dir_);
   
@@ -554,7 +484,7 @@ void TorqueJointSpaceControllerJointTest::insert(const Eigen::Vector3d position,
     insert_start_time_ = cur_time_;
 
     is_insert_first_ = false;
-    std::cout<<"start insert"<<std::endl;
+    RT_LOG_INFO("start insert");
   }
   f_asm = ori_init_*f_asm;
 
@@ -577,7 +507,7 @@ void TorqueJointSpaceControllerJointTest::release(const Eigen::Vector3d position
     ori_init_ = rotation;
     release_start_time_ = cur_time_;
     is_release_first_ = false;
-    std::cout<<"start release"<<std::endl;
+    RT_LOG_INFO("start release");
   }
 
   f_star = keepCurrentState(pos_init_, ori_init_, position, rotation, xd, 5000, 100).head<3>();
@@ -590,15 +520,8 @@ void TorqueJointSpaceControllerJointTest::release(const Eigen::Vector3d position
 
 void TorqueJointSpaceControllerJointTest::gripperClose()
 {
-    franka_gripper::GraspGoal goal;
-    franka_gripper::GraspEpsilon epsilon;
-    epsilon.inner = 0.01;
-    epsilon.outer = 0.02;
-    goal.speed = 0.01;
-    goal.width = 0.03;
-    goal.force = 100.0;
-    goal.epsilon = epsilon;
-    gripper_ac_close_.sendGoal(goal);
+    // width, speed, force, epsilon inner/outer
+    gripper_.grasp(0.03, 0.01, 100.0, 0.01, 0.02);
 }
 
 
@@ -12,18 +12,17 @@
 #include "math_type_define.h"
 
 #include "advanced_robotics_franka_controllers/torque_joint_space_controller_rrt.h"
+#include <advanced_robotics_franka_controllers/panda_kinematics.h>
 
 
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerRRT::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerRRT::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   
   //ros::init( argc, argv, "assembly_vrep");
   joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");  
-  gripper_ac_.waitForServer();
-  gripper_ac_open.waitForServer();
 
   //joint_state_pub_ = node_handle.advertise<sensor_msgs::JointState>("/panda/left_joint_states", 1);
   // goal_state_pub_ = node_handle.advertise<geometry_msgs::Transform>("/panda/left_goal_trans", 1);
@@ -41,72 +40,17 @@ bool TorqueJointSpaceControllerRRT::init(hardware_interface::RobotHW* robot_hw,
 
   gripper_done = false;
   gripper_open = false;
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
   return true;
 }
 
 void TorqueJointSpaceControllerRRT::traj_cb(const sensor_msgs::JointStateConstPtr& msg)
 {
-    for (size_t i = 0; i < msg->position.size(); i++)
+    if (msg->position.size() != 7)
     {
-        q_traj_[i] = msg->position[i];
+        ROS_WARN_THROTTLE(1.0, "TorqueJointSpaceControllerRRT: trajectory point needs 7 positions");
+        return;
     }
+    trajectory_in_.write(Eigen::Matrix<double, 7, 1>::Map(msg->position.data()));
 }
 
 
@@ -114,29 +58,33 @@ void TorqueJointSpaceControllerRRT::traj_cb(const sensor_msgs::JointStateConstPt
 
 void TorqueJointSpaceControllerRRT::planned_cb(const std_msgs::Bool& msg)
 {
-    planned_done = msg.data;
+    planned_done_in_.write(msg.data);
 }
 
 void TorqueJointSpaceControllerRRT::grip_cb(const std_msgs::Bool& msg)
 {
-    gripper_done = msg.data;
-    gripper_open = false;
+    gripper_close_in_.write(msg.data);
 }
 
 void TorqueJointSpaceControllerRRT::grip_open_cb(const std_msgs::Bool& msg)
 {
-
-    gripper_open = msg.data;
-    gripper_done = false;
+    gripper_open_in_.write(msg.data);
 }
 
 void TorqueJointSpaceControllerRRT::starting(const ros::Time& time) {
+  gripper_.reset();
   start_time_ = time;
+  // apply what arrived while stopped before the resets below
+  receiveCommands();
 
   for (size_t i = 0; i < 7; ++i)
   {
     q_init_(i) = joint_handles_[i].getPosition();
   }
+
+  Eigen::Matrix<double, 7, 1> q_goal;
+  q_goal << M_PI/2, 0.0, 0.0, -M_PI/2, 0, M_PI/2, M_PI/4;
+  homing_ = MultiCubicSegment<7>(start_time_.toSec(), start_time_.toSec() + 5.0, q_init_, q_goal);
   //q_traj_ = q_init_;
 
   const franka::RobotState &robot_state = state_handle_->getRobotState();
@@ -185,42 +133,26 @@ void TorqueJointSpaceControllerRRT::starting(const ros::Time& time) {
 
 }
 
-void TorqueJointSpaceControllerRRT::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
+void TorqueJointSpaceControllerRRT::updateController(const ros::Time& time, const ros::Duration& period) {
+  receiveCommands();
 
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
-  Eigen::Matrix<double , 7, 1> q_goal;
   Eigen::Matrix<double , 7, 1> q_desired;
   Eigen::Matrix<double , 7, 1> qd_desired;
   Eigen::Matrix<double , 12, 1> x_goal; 
   Eigen::Matrix<double , 12, 1> x_desired;
   Eigen::Matrix<double , 12, 1> x_current;
   
-  q_goal.setZero();
-  q_goal << M_PI/2, 0.0, 0.0, -M_PI/2, 0, M_PI/2, M_PI/4;
   q_desired.setZero();
 
   //q_goal = q_init_;
@@ -233,7 +165,9 @@ void TorqueJointSpaceControllerRRT::update(const ros::Time& time, const ros::Dur
   Eigen::Vector3d position(transform.translation());
   Eigen::Matrix<double, 3, 3> rotation_M;//(transform.rotation());
 
-	rotation_M = Rotate_with_Z(q(0))*Rotate_with_Y(q(1))*Rotate_with_Z(q(2))*Rotate_with_Y(-q(3))*Rotate_with_Z(q(4))*Rotate_with_Y(-q(5))*Rotate_with_Z(-(q(6)));
+  // joint 7 body frame orientation
+  const PandaKinematics kinematics(q);
+  rotation_M = kinematics.flangeRotation() * Eigen::Vector3d(1, -1, -1).asDiagonal();
 
 //////////////////////////////////////////////////////////////////////////
   Eigen::Vector6d x_dot_(jacobian*qd);
@@ -274,15 +208,9 @@ void TorqueJointSpaceControllerRRT::update(const ros::Time& time, const ros::Dur
 
   //////////////////////////////////////////////////////////////////////////
 
-  double trajectory_time = 5.0;
-  for(int i=0; i<7;i++)
-  {
-    q_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-                                        q_init_(i), q_goal(i), 0, 0);
-    qd_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-                                        q_init_(i), q_goal(i), 0, 0);
-
-  }
+  const MultiTrajectoryPoint<7> desired = homing_.evaluate(time.toSec());
+  q_desired = desired.position;
+  qd_desired = desired.velocity;
   // goal_trans_state_.translation
   // goal_trans_state_.rotation
   qd_desired.setZero();
@@ -345,105 +273,65 @@ void TorqueJointSpaceControllerRRT::update(const ros::Time& time, const ros::Dur
     //joint_handles_[i].setCommand(0);
   }
 
-    if(gripper_done){
-      franka_gripper::GraspGoal goal;
-      franka_gripper::GraspEpsilon epsilon;
-      epsilon.inner = 0.01;
-      epsilon.outer = 0.01;
-      goal.speed = 0.1;
-      goal.width = 0.05;
-      goal.force = 100.0;
-      goal.epsilon = epsilon;
-      gripper_ac_.sendGoal(goal);
-    
-    }
-
-    if(gripper_open){
-      franka_gripper::MoveGoal goal;
-      goal.speed = 0.1;
-      goal.width = 0.08;
-    
-      gripper_ac_open.sendGoal(goal);
+    // one goal per /gripper or /gripper_open message, sent again only if it
+    // failed; the flag is cleared once the goal succeeded
+    if ((gripper_done || gripper_open) && gripper_.state() != GripperDispatcher::State::kPending)
+    {
+      if (gripper_.state() == GripperDispatcher::State::kSucceeded)
+      {
+        gripper_done = false;
+        gripper_open = false;
       }
-}
-
-
-Matrix3d TorqueJointSpaceControllerRRT::Rotate_with_X(const double rAngle)
-{
-	Matrix3d _Rotate_wth_X;
-
-	_Rotate_wth_X(0, 0) = 1.0;
-	_Rotate_wth_X(1, 0) = 0.0;
-	_Rotate_wth_X(2, 0) = 0.0;
-
-	_Rotate_wth_X(0, 1) = 0.0;
-	_Rotate_wth_X(1, 1) = cos(rAngle);
-	_Rotate_wth_X(2, 1) = sin(rAngle);
-
-	_Rotate_wth_X(0, 2) = 0.0;
-	_Rotate_wth_X(1, 2) = -sin(rAngle);
-	_Rotate_wth_X(2, 2) = cos(rAngle);
-
-	return(_Rotate_wth_X);
-}
-
-Matrix3d TorqueJointSpaceControllerRRT::Rotate_with_Y(const double rAngle)
-{
-	Matrix3d _Rotate_wth_Y(3, 3);
-
-	_Rotate_wth_Y(0, 0) = cos(rAngle);
-	_Rotate_wth_Y(1, 0) = 0.0;
-	_Rotate_wth_Y(2, 0) = -sin(rAngle);
-
-	_Rotate_wth_Y(0, 1) = 0.0;
-	_Rotate_wth_Y(1, 1) = 1.0;
-	_Rotate_wth_Y(2, 1) = 0.0;
-
-	_Rotate_wth_Y(0, 2) = sin(rAngle);
-	_Rotate_wth_Y(1, 2) = 0.0;
-	_Rotate_wth_Y(2, 2) = cos(rAngle);
-
-	return(_Rotate_wth_Y);
-}
-
-Matrix3d TorqueJointSpaceControllerRRT::Rotate_with_Z(const double rAngle)
-{
-	Matrix3d _Rotate_wth_Z(3, 3);
-
-	_Rotate_wth_Z(0, 0) = cos(rAngle);
-	_Rotate_wth_Z(1, 0) = sin(rAngle);
-	_Rotate_wth_Z(2, 0) = 0.0;
-
-	_Rotate_wth_Z(0, 1) = -sin(rAngle);
-	_Rotate_wth_Z(1, 1) = cos(rAngle);
-	_Rotate_wth_Z(2, 1) = 0.0;
-
-	_Rotate_wth_Z(0, 2) = 0.0;
-	_Rotate_wth_Z(1, 2) = 0.0;
-	_Rotate_wth_Z(2, 2) = 1.0;
-
-	return(_Rotate_wth_Z);
+      else if (gripper_done)
+        gripper_.grasp(0.05, 0.1, 100.0, 0.01, 0.01);
+      else
+        gripper_.move(0.08, 0.1);
+    }
 }
 
 
 void TorqueJointSpaceControllerRRT::commandForceCallback(const geometry_msgs::WrenchConstPtr& msg)
 {
-  f_star_zero_(0) = msg -> force.x;
-  f_star_zero_(1) = msg -> force.y;
-  f_star_zero_(2) = msg -> force.z;
-  f_star_zero_(3) = msg -> torque.x;
-  f_star_zero_(4) = msg -> torque.y;
-  f_star_zero_(5) = msg -> torque.z;
+  Eigen::Matrix<double, 6, 1> f_star_zero;
+  f_star_zero << msg -> force.x, msg -> force.y, msg -> force.z, msg -> torque.x, msg -> torque.y, msg -> torque.z;
+  f_star_zero_in_.write(f_star_zero);
 }
 
 void TorqueJointSpaceControllerRRT::pegInHoleStateCallback(const std_msgs::Int32ConstPtr& msg)
 {
-  peg_in_hole_state_ = msg -> data;
+  peg_in_hole_state_in_.write(msg -> data);
 }
 
 void TorqueJointSpaceControllerRRT::taskStartCallback(const std_msgs::Bool& msg)
 {
-  task_start_ = msg.data;
+  task_start_in_.write(msg.data);
+}
+
+void TorqueJointSpaceControllerRRT::receiveCommands()
+{
+  if (trajectory_in_.read())
+    q_traj_ = trajectory_in_.value();
+  if (planned_done_in_.read())
+    planned_done = planned_done_in_.value();
+  // a new message is a new request, even if it repeats the last one
+  if (gripper_close_in_.read())
+  {
+    gripper_done = gripper_close_in_.value();
+    gripper_open = false;
+    gripper_.reset();
+  }
+  if (gripper_open_in_.read())
+  {
+    gripper_open = gripper_open_in_.value();
+    gripper_done = false;
+    gripper_.reset();
+  }
+  if (f_star_zero_in_.read())
+    f_star_zero_ = f_star_zero_in_.value();
+  if (peg_in_hole_state_in_.read())
+    peg_in_hole_state_ = peg_in_hole_state_in_.value();
+  if (task_start_in_.read())
+    task_start_ = task_start_in_.value();
 }
 
 
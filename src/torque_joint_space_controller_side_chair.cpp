@@ -1,4 +1,5 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_side_chair.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
 #include <cmath>
 #include <memory>
 
@@ -18,7 +19,7 @@
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerSideChair::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerSideChair::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
   //joint0_data = fopen("/home/dyros/catkin_ws/src/dyros_mobile_manipulator_controller/joint0_data.txt","w");
   save_data_x = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE_spiral/save_data_fm.txt","w");   
@@ -26,63 +27,9 @@ bool TorqueJointSpaceControllerSideChair::init(hardware_interface::RobotHW* robo
   save_result = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE_spiral/save_result.txt","w");
   save_dir = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE_spiral/save_dir.txt","w");
   save_cmd = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LEE_spiral/save_cmd.txt","w");
-  std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
 
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
+  // an approach ends after 1000 ticks in contact
+  direction_history_.allocate(1000, SignalHistory<kDirectionChannels>::kOverwriteOldest);
   return true;
 }
 
@@ -92,6 +39,10 @@ void TorqueJointSpaceControllerSideChair::starting(const ros::Time& time) {
   for (size_t i = 0; i < 7; ++i) {
     q_init_(i) = joint_handles_[i].getPosition();
   }
+
+  Eigen::Matrix<double, 7, 1> q_goal;
+  q_goal << 0.0, -M_PI/6, 0.0, -2*M_PI/3, 0, M_PI/2, M_PI/4;
+  homing_ = MultiCubicSegment<7>(start_time_.toSec(), start_time_.toSec() + 5.0, q_init_, q_goal);
   
   const franka::RobotState &robot_state = state_handle_->getRobotState();
   transform_init_ = Eigen::Matrix4d::Map(robot_state.O_T_EE.data());
@@ -132,47 +83,27 @@ void TorqueJointSpaceControllerSideChair::starting(const ros::Time& time) {
 }
 
 
-void TorqueJointSpaceControllerSideChair::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array = model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void TorqueJointSpaceControllerSideChair::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
-  Eigen::Matrix<double , 7, 1> q_goal;
   Eigen::Matrix<double , 7, 1> q_desired;
   Eigen::Matrix<double , 7, 1> qd_desired;
   Eigen::Matrix<double , 12, 1> x_goal; 
   Eigen::Matrix<double , 12, 1> x_desired;
   Eigen::Matrix<double , 12, 1> x_current;
 
-  Eigen::Matrix<double, 6, 6> lambda;
-  Eigen::Matrix<double, 7, 6> j_bar;
 
-  lambda = (jacobian*mass_matrix.inverse()*jacobian.transpose()).inverse();
-  j_bar = mass_matrix.inverse()*jacobian.transpose()*lambda;
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
 
-  q_goal.setZero();
-  q_goal << 0.0, -M_PI/6, 0.0, -2*M_PI/3, 0, M_PI/2, M_PI/4;
   q_desired.setZero();
 
   ros::Duration simulation_time = time - start_time_;
@@ -184,17 +115,12 @@ void TorqueJointSpaceControllerSideChair::update(const ros::Time& time, const ro
 
   Eigen::Vector6d x_dot_(jacobian*qd);
 
-  double trajectory_time = 5.0;
-  for(int i=0; i<7;i++)
-  {
-    q_desired(i) = DyrosMath::cubic(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-                                        q_init_(i), q_goal(i), 0, 0);
-    qd_desired(i) = DyrosMath::cubicDot(time.toSec(), start_time_.toSec(), start_time_.toSec() + trajectory_time,
-                                        q_init_(i), q_goal(i), 0, 0);
-  }
+  const MultiTrajectoryPoint<7> desired = homing_.evaluate(time.toSec());
+  q_desired = desired.position;
+  qd_desired = desired.velocity;
 
   
-  f_sensing_ = j_bar.transpose()*(tau_measured - gravity);
+  f_sensing_ = op_space.wrench(tau_measured - gravity);
   f_sensing_ee_.head<3>() = rotation_M.transpose()*f_sensing_.head<3>();
   f_sensing_ee_.tail<3>() = rotation_M.transpose()*f_sensing_.tail<3>();
   ////////////////////
@@ -298,15 +224,15 @@ void TorqueJointSpaceControllerSideChair::update(const ros::Time& time, const ro
           
           if(time.toSec() - revolve_start_time_ > 1.0)
           {
-            double temp_mx = fabs(mx_ee_.back() - initial_moment_(0));
-            double temp_my = fabs(my_ee_.back() - initial_moment_(1));
+            double temp_mx = fabs(moment_ee_(0) - initial_moment_(0));
+            double temp_my = fabs(moment_ee_(1) - initial_moment_(1));
         
             if(temp_mx >= 2.5 && temp_my >= 2.5)
             {
               contact_points_++;
               std::cout<<"CHECK CONTACT, moment limit"<<std::endl;
               std::cout<<temp_mx<<" "<<temp_my<<std::endl;
-              std::cout<<mx_ee_.back()<<" "<<my_ee_.back()<<std::endl;
+              std::cout<<moment_ee_(0)<<" "<<moment_ee_(1)<<std::endl;
               std::cout<<initial_moment_(0)<<" "<<initial_moment_(1)<<std::endl;
               std::cout<<time.toSec() - revolve_start_time_<<std::endl;
             }          
@@ -434,7 +360,7 @@ void TorqueJointSpaceControllerSideChair::revolve(const ros::Time& time,
     is_revolve_first_ = false;
     is_keep_state_first_ = true;
     index_ = 500;
-    clearMoment();
+    clearMoment(revolve_start_time_ + 0.5*duration);
     std::cout<<"Revolve start!"<<std::endl;
   }
   
@@ -451,7 +377,7 @@ void TorqueJointSpaceControllerSideChair::revolve(const ros::Time& time,
     f_star_ = keepCurrentPosition(revolve_origin_, position, x_dot_);
     f_star_(2) = -25.0;//final_force_;
     m_star_ = rotateWithGivenAxis(axis, initial_rotation_M, rotation_M, x_dot_, ang_vel, range, time.toSec(), revolve_start_time_); 
-    getMoment(f_sensing_, f_sensing_ee_);   
+    getMoment(time, f_sensing_, f_sensing_ee_);   
   }   
   else if(play_time > duration && play_time <= 2*duration)
   {
@@ -461,7 +387,7 @@ void TorqueJointSpaceControllerSideChair::revolve(const ros::Time& time,
       initial_rotation_M = rotation_M;
       revolve_direction_ ++;
       // detect_contact_ = checkSideChairDone(mx_,my_,mz_,1.8);
-      detect_contact_ = checkSideChairDone(mx_ee_,my_ee_,mz_ee_,1.5);
+      detect_contact_ = checkSideChairDone(moment_slope_,1.5);
       if(detect_contact_ == true)
       {
         contact_points_++;
@@ -482,14 +408,14 @@ void TorqueJointSpaceControllerSideChair::revolve(const ros::Time& time,
       initial_rotation_M = rotation_M;
       revolve_direction_ ++;
       index_ = 500;
-      clearMoment();
+      clearMoment(revolve_start_time_ + 2.5*duration);
       std::cout<<"Keep revolving"<<std::endl;
     }
 
     f_star_ = keepCurrentPosition(revolve_origin_, position, x_dot_);
     f_star_(2) = -25.0;//final_force_;
     m_star_ = rotateWithGivenAxis(axis, initial_rotation_M, rotation_M, x_dot_, -ang_vel, -range, time.toSec(), revolve_start_time_ + 2*duration);
-    getMoment(f_sensing_, f_sensing_ee_);   
+    getMoment(time, f_sensing_, f_sensing_ee_);   
   }
   else
   {
@@ -499,7 +425,7 @@ void TorqueJointSpaceControllerSideChair::revolve(const ros::Time& time,
       initial_rotation_M = rotation_M;
       revolve_direction_ ++;
       // detect_contact_ = checkSideChairDone(mx_,my_,mz_,1.8);
-      detect_contact_ = checkSideChairDone(mx_ee_,my_ee_,mz_ee_,1.5);
+      detect_contact_ = checkSideChairDone(moment_slope_,1.5);
       if(detect_contact_ == true)
       {
         contact_points_++;
@@ -569,49 +495,43 @@ void TorqueJointSpaceControllerSideChair::getInitialFT(const int index)
 
 void TorqueJointSpaceControllerSideChair::getDirectionVector(const Eigen::Vector3d position, const Eigen::Matrix3d rotation)
 {
-  nx_.push_back(-rotation(0,2));
-  ny_.push_back(-rotation(1,2));
-  nz_.push_back(-rotation(2,2));
-  ex_.push_back(position(0));
-  ey_.push_back(position(1));
-  ez_.push_back(position(2));
-  p_.push_back(nx_.back()*ex_.back() + ny_.back()*ey_.back() + nz_.back()*ez_.back());
+  SignalHistory<kDirectionChannels>::Sample sample;
+  sample << -rotation.col(2), position, 0.0;
+  sample(kP) = sample.segment<3>(kNx).dot(sample.segment<3>(kEx));
+  direction_history_.push(sample);
 
-  fprintf(save_dir, "%f\t %f\t %f\t %f\t %f\t %f\t %f\t\n", ex_.back(), ey_.back(), ez_.back(), nx_.back(), ny_.back(), nz_.back(), p_.back());
+  fprintf(save_dir, "%f\t %f\t %f\t %f\t %f\t %f\t %f\t\n", sample(kEx), sample(kEy), sample(kEz), sample(kNx), sample(kNy), sample(kNz), sample(kP));
 
 }
 
 void TorqueJointSpaceControllerSideChair::clearDirectionVector()
 {
-  nx_.clear();
-  ny_.clear();
-  nz_.clear();
-  ex_.clear();
-  ey_.clear();
-  ez_.clear();
-  p_.clear();
+  direction_history_.clear();
 }
-void TorqueJointSpaceControllerSideChair::getMoment(const Eigen::Matrix<double, 6, 1> f,
+void TorqueJointSpaceControllerSideChair::getMoment(const ros::Time& time,
+  const Eigen::Matrix<double, 6, 1> f,
   const Eigen::Matrix<double, 6, 1> f_ee)
 {
-  mx_.push_back(f(3));
-  my_.push_back(f(4));
-  mz_.push_back(f(5));
-  mx_ee_.push_back(f_ee(3));
-  my_ee_.push_back(f_ee(4));
-  mz_ee_.push_back(f_ee(5));
-  // std::cout<<mx_.back()<<std::endl;
-  fprintf(save_result, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", mx_.back(), my_.back(), mz_.back(), mx_ee_.back(), my_ee_.back(), mz_ee_.back());
+  moment_ = f.tail<3>();
+  moment_ee_ = f_ee.tail<3>();
+  const int half = time.toSec() < moment_split_time_ ? 0 : 1;
+  for(int i = 0; i < 3; i++)
+  {
+    moment_slope_[half][i].add(time.toSec(), moment_ee_(i));
+  }
+  fprintf(save_result, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", moment_(0), moment_(1), moment_(2), moment_ee_(0), moment_ee_(1), moment_ee_(2));
 }
 
-void TorqueJointSpaceControllerSideChair::clearMoment()
+void TorqueJointSpaceControllerSideChair::clearMoment(const double split_time)
 {
-  mx_.clear();
-  my_.clear();
-  mz_.clear();
-  mx_ee_.clear();
-  my_ee_.clear();
-  mz_ee_.clear();
+  for(int i = 0; i < 3; i++)
+  {
+    moment_slope_[0][i].reset();
+    moment_slope_[1][i].reset();
+  }
+  moment_split_time_ = split_time;
+  moment_.setZero();
+  moment_ee_.setZero();
 }
 
 } // namespace advanced_robotics_franka_controllers
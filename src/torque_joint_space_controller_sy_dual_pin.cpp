@@ -1,4 +1,5 @@
 #include <advanced_robotics_franka_controllers/torque_joint_space_controller_sy_dual_pin.h>
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
 #include <cmath>
 #include <memory>
 #include <iostream>
@@ -20,75 +21,19 @@
 namespace advanced_robotics_franka_controllers
 {
 
-bool TorqueJointSpaceControllerSyDualPin::init(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
+bool TorqueJointSpaceControllerSyDualPin::initController(hardware_interface::RobotHW* robot_hw, ros::NodeHandle& node_handle)
 {
-  joint0_data = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/joint0_data.txt","w");
-  save_data_x = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_data_fm.txt","w");
-  save_data_x2 = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_data_pr.txt","w");
-  save_data_x3 = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/save_data_daul_time.txt","w");
-
-  reaction_force = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/reaction_force.txt","w");
-  save_cmd = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/iros/save_cmd.txt","w");
-  save_fm = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/iros/save_fm.txt","w");
-  gain_tunning = fopen("/home/dyros/catkin_ws/src/advanced_robotics_franka_controllers/experiment_data/LHS/iros/gain_tunning.txt","w");
-
-	std::vector<std::string> joint_names;
-  std::string arm_id;
-  ROS_WARN(
-      "ForceExampleController: Make sure your robot's endeffector is in contact "
-      "with a horizontal surface before starting the controller!");
-  if (!node_handle.getParam("arm_id", arm_id)) {
-    ROS_ERROR("ForceExampleController: Could not read parameter arm_id");
-    return false;
-  }
-  if (!node_handle.getParam("joint_names", joint_names) || joint_names.size() != 7) {
-    ROS_ERROR(
-        "ForceExampleController: Invalid or no joint_names parameters provided, aborting "
-        "controller init!");
-    return false;
-  }
-
-  auto* model_interface = robot_hw->get<franka_hw::FrankaModelInterface>();
-  if (model_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting model interface from hardware");
-    return false;
-  }
-  try {
-    model_handle_ = std::make_unique<franka_hw::FrankaModelHandle>(
-        model_interface->getHandle(arm_id + "_model"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting model handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* state_interface = robot_hw->get<franka_hw::FrankaStateInterface>();
-  if (state_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting state interface from hardware");
-    return false;
-  }
-  try {
-    state_handle_ = std::make_unique<franka_hw::FrankaStateHandle>(
-        state_interface->getHandle(arm_id + "_robot"));
-  } catch (hardware_interface::HardwareInterfaceException& ex) {
-    ROS_ERROR_STREAM(
-        "ForceExampleController: Exception getting state handle from interface: " << ex.what());
-    return false;
-  }
-
-  auto* effort_joint_interface = robot_hw->get<hardware_interface::EffortJointInterface>();
-  if (effort_joint_interface == nullptr) {
-    ROS_ERROR_STREAM("ForceExampleController: Error getting effort joint interface from hardware");
-    return false;
-  }
-  for (size_t i = 0; i < 7; ++i) {
-    try {
-      joint_handles_.push_back(effort_joint_interface->getHandle(joint_names[i]));
-    } catch (const hardware_interface::HardwareInterfaceException& ex) {
-      ROS_ERROR_STREAM("ForceExampleController: Exception getting joint handles: " << ex.what());
-      return false;
-    }
-  }
+  theta_channel_ = telemetry_.addChannel("LHS/joint0_data", 2);
+  torque_channel_ = telemetry_.addChannel("LHS/save_data_fm", 7);
+  position_channel_ = telemetry_.addChannel("LHS/save_data_pr", 10);
+  time_channel_ = telemetry_.addChannel("LHS/save_data_daul_time", 4);
+  cmd_channel_ = telemetry_.addChannel("LHS/iros/save_cmd", 8);
+  force_moment_channel_ = telemetry_.addChannel("LHS/iros/save_fm", 8);
+  gain_tunning_channel_ = telemetry_.addChannel("LHS/iros/gain_tunning", 6);
+  std::string telemetry_file;
+  // relative paths land in the working directory of the node, $ROS_HOME by default
+  node_handle.param<std::string>("telemetry_file", telemetry_file, "sy_dual_pin.bin");
+  telemetry_.open(telemetry_file);
 
   return true;
 }
@@ -190,30 +135,15 @@ void TorqueJointSpaceControllerSyDualPin::starting(const ros::Time& time) {
 }
 
 
-void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ros::Duration& period) {
-
-  const franka::RobotState &robot_state = state_handle_->getRobotState();
-  const std::array<double, 42> &jacobian_array =
-      model_handle_->getZeroJacobian(franka::Frame::kEndEffector);
-  const std::array<double, 7> &gravity_array = model_handle_->getGravity();
-  const std::array<double, 49> &massmatrix_array = model_handle_->getMass();
-  const std::array<double, 7> &coriolis_array = model_handle_->getCoriolis();
-
-  const std::array<double, 3ul> gravity_dir = {{0., .0, 9.81}};
-  double theta = 15.0;
-
-  std::array<double, 7> gravity2 = model_handle_->getGravity({{9.81*sin(theta*M_PI/180.0), 0.0, -9.81*cos(theta*M_PI/180.0)}});//franka::Model::gravity(robot_state, gravity_dir);
-
-  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(jacobian_array.data());
+void TorqueJointSpaceControllerSyDualPin::updateController(const ros::Time& time, const ros::Duration& period) {
+  const franka::RobotState &robot_state = snapshot_.robotState();
+  Eigen::Map<const Eigen::Matrix<double, 6, 7>> jacobian(snapshot_.jacobian().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_measured(robot_state.tau_J.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> tau_J_d(robot_state.tau_J_d.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(gravity_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(massmatrix_array.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> coriolis(coriolis_array.data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 1>> gravity(snapshot_.gravity().data());
+  Eigen::Map<const Eigen::Matrix<double, 7, 7>> mass_matrix(snapshot_.mass().data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> q(robot_state.q.data());
   Eigen::Map<const Eigen::Matrix<double, 7, 1>> qd(robot_state.dq.data());
-  Eigen::Map<const Eigen::Matrix<double, 7, 1>> graivity_mod(gravity2.data());
-
 
   Eigen::Matrix<double , 6, 7> jacobian_euler;
   Eigen::Matrix<double , 12, 7> jacobian_dc;
@@ -240,18 +170,15 @@ void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ro
   jacobian_pos_ = jacobian.block(0, 0, 3, 7);
 
   //f_sensing = (jacobian * jacobian.transpose()).inverse() * jacobian * (tau_measured - gravity);
-  f_sensing = (jacobian * mass_matrix.inverse() * jacobian.transpose()).inverse() * jacobian * mass_matrix.inverse() * (tau_measured - gravity);
+  OperationalSpaceDynamics op_space(mass_matrix, jacobian);
+  f_sensing = op_space.wrench(tau_measured - gravity);
 
 
-  Eigen::Matrix<double, 6, 6> lambda;
-  Eigen::Matrix<double, 7, 6> J_bar;
   Eigen::Matrix<double, 6, 1> f_measured;
   Eigen::Vector3d force_ee; //w.r.t end-effector
   Eigen::Vector3d moment_ee;
 
-  lambda = (jacobian*mass_matrix.inverse()*jacobian.transpose()).inverse();
-  J_bar = mass_matrix.inverse()*jacobian.transpose()*lambda;
-  f_measured = J_bar.transpose()*(tau_measured - gravity); //w.r.t global frame
+  f_measured = op_space.wrench(tau_measured - gravity); //w.r.t global frame
 
   force_ee = rotation_M.transpose()*f_measured.head<3>();
   moment_ee = rotation_M.transpose()*f_measured.tail<3>();
@@ -684,6 +611,7 @@ void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ro
       spiral_linear_velocity_ = input_vel_spiral;
       spiral_pitch_ = 0.001; //0.0025 //0.000907
       spiral_duration_ = 3000.0;
+      spiral_.reset(spiral_origin_.head<2>(), spiral_linear_velocity_, spiral_pitch_, spiral_duration_);
       spiral_force_limit_ = 10; //7
       force_press_z_ = -10.0; //-10
       target_rotation_ = rotation_M;
@@ -750,7 +678,7 @@ void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ro
     //   // std::cout << "SPIRAL MOTIN IS DONE" << std::endl;
     // }
 
-    x_desired_.block<2, 1>(0, 0) = DyrosMath::spiral(time.toSec(), spiral_start_time_.toSec(), spiral_start_time_.toSec() + spiral_duration_, spiral_origin_.block<2, 1>(0, 0), spiral_linear_velocity_, spiral_pitch_); //0.0035 //0.02
+    x_desired_.block<2, 1>(0, 0) = spiral_.advance(period.toSec());
     x_desired_(2) = spiral_origin_(2);
     xdot_desired_.setZero();                                                                                                                                                                                             // in "approach process", z velocity is not "zero"
 
@@ -874,7 +802,7 @@ void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ro
     //ori_theta_z_real_ = acos(rotation_z_theta_real_(0));
     // ori_theta_z_real_ = -1*asin((-1)*rotation_z_theta_real_(1));
     ori_theta_z_real_ = atan2(rotation_z_theta_real_(1,0),rotation_z_theta_real_(0,0));
-    fprintf(gain_tunning, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", x_desired_(0), x_desired_(1), ori_theta_z_, position(0), position(1), ori_theta_z_real_);
+    telemetry_.record(gain_tunning_channel_, x_desired_(0), x_desired_(1), ori_theta_z_, position(0), position(1), ori_theta_z_real_);
   }
   // else if(pin_state_ == 3)
   // {
@@ -1214,7 +1142,7 @@ void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ro
       pin_state_ = 8;
       is_first_ = true;
 
-      fprintf(save_data_x3, "%lf\t %lf\t %lf\t %lf\t\n", finish_time.toSec(), approach_time.toSec(), spiral_time.toSec(), insert_time.toSec());
+      telemetry_.record(time_channel_, finish_time.toSec(), approach_time.toSec(), spiral_time.toSec(), insert_time.toSec());
     }
 
 
@@ -2092,13 +2020,13 @@ void TorqueJointSpaceControllerSyDualPin::update(const ros::Time& time, const ro
 
   }
 
-  fprintf(joint0_data, "%lf\t %lf\t\n", ori_theta_z_, ori_theta_z_real_);
-  fprintf(save_data_x2, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", position(0), position(1), position(2), x_desired_(0), x_desired_(1), x_desired_(2), euler_angle(0), euler_angle(1), euler_angle(2), spiral_force_);
-  fprintf(save_data_x, "%lf\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", tau_cmd(0), tau_cmd(1), tau_cmd(2), tau_cmd(3), tau_cmd(4), tau_cmd(5), tau_cmd(6));
+  telemetry_.record(theta_channel_, ori_theta_z_, ori_theta_z_real_);
+  telemetry_.record(position_channel_, position(0), position(1), position(2), x_desired_(0), x_desired_(1), x_desired_(2), euler_angle(0), euler_angle(1), euler_angle(2), spiral_force_);
+  telemetry_.recordArray(torque_channel_, tau_cmd.data(), 7);
   //fprintf(save_data_x2, "%lf  \t %lf\t %lf\t %lf\t %lf\t %lf\t\n", x_dot_(0), x_dot_(1), x_dot_(2), x_dot_(3), x_dot_(4), x_dot_(5));
 
-  fprintf(save_cmd, "%lf\t %d\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", simulation_time.toSec(), pin_state_,f_star_zero_(0), f_star_zero_(1), f_star_zero_(2), f_star_zero_(3), f_star_zero_(4), f_star_zero_(5));
-  fprintf(save_fm, "%lf\t %d\t %lf\t %lf\t %lf\t %lf\t %lf\t %lf\t\n", simulation_time.toSec(), pin_state_,force_ee(0), force_ee(1), force_ee(2), moment_ee(0), moment_ee(1), moment_ee(2));
+  telemetry_.record(cmd_channel_, simulation_time.toSec(), pin_state_, f_star_zero_(0), f_star_zero_(1), f_star_zero_(2), f_star_zero_(3), f_star_zero_(4), f_star_zero_(5));
+  telemetry_.record(force_moment_channel_, simulation_time.toSec(), pin_state_, force_ee(0), force_ee(1), force_ee(2), moment_ee(0), moment_ee(1), moment_ee(2));
 
   for (size_t i = 0; i < 7; ++i) {
     joint_handles_[i].setCommand(tau_cmd(i));
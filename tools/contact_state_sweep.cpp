@@ -0,0 +1,487 @@
+// Evaluates candidate membership breakpoints (Criteria::fuzzyLogic) and
+// thresholds (Criteria::crispLogic) of the peg in hole contact state
+// classifier against recorded fuzzy_io.txt dumps of
+// TorqueJointSpaceControllerFuzzy, on every core.
+//
+// The manifest lists one run per line, "<true contact state> <fuzzy_io.txt>",
+// with the state as in fuzzycontrol.h (3 = CS_THREE ... 6 = CS_FIVE_TWO).
+// Only the search ticks of a dump are replayed. The controller writes a row
+// after the state switch of its tick, so the first SEARCH row is the contact
+// tick of APPROACH, which is skipped: search() only sets the origin on the
+// next tick, whose z is the origin here. Likewise the tick that decided is
+// logged as INSERT or ESCAPE; that first row after the SEARCH rows is
+// replayed as the last search tick and carries the recorded decision. A run
+// without one was still searching when the dump ended. Each candidate is
+// debounced like the controller
+// (20 ticks of a steady output) and decides at the first steady terminal
+// state (CS_THREE .. CS_FIVE_TWO), or stays undecided until the end of the
+// recorded search. For each classifier the tool reports the tuned set and
+// the best candidates (by correct decisions, then by mean latency) with
+// their confusion matrix and detection latency.
+//
+// Candidates are either [candidates] random sets around the tuned one, each
+// breakpoint scaled by 1 + u spread with u uniform in [-1, 1], or read from a
+// file with one set per line: 3 velocity, 9 displacement and 5 force
+// breakpoints, then 1 velocity, 4 displacement and 2 force thresholds.
+//
+// usage: rosrun advanced_robotics_franka_controllers contact_state_sweep
+//            <manifest> [candidates | candidate file] [spread] [best]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "criteria.h"
+
+namespace
+{
+const int kSearch = 1;       // status_ of TorqueJointSpaceControllerFuzzy
+const double kTickSeconds = 0.001;
+const int kStates = 7;       // NONE .. CS_FIVE_TWO
+const int kUndecided = kStates;
+
+// search ticks of one dump, channel by channel
+struct Run
+{
+  std::string file_name;
+  int state;
+  std::vector<double> velocity;
+  std::vector<double> position;
+  std::vector<double> force;
+  // the recorded search ended with a decision on its last tick
+  bool decided;
+  // fuzzy_output_ and crisp_output_ of the last search tick
+  double recorded_fuzzy;
+  double recorded_crisp;
+};
+
+struct Candidate
+{
+  double velocity[3];
+  double displacement[9];
+  double force[5];
+  CrispLogic::ContactStateThresholds thresholds;
+};
+
+struct Score
+{
+  int confusion[kStates][kStates + 1];
+  int correct;
+  double latency_sum;  // seconds, over correct decisions
+  double latency_max;
+
+  double meanLatency() const { return correct > 0 ? latency_sum / correct : 0.0; }
+};
+
+struct Result
+{
+  Score fuzzy;
+  Score crisp;
+};
+
+bool isTerminal(double state)
+{
+  return state == CS_THREE || state == CS_FOUR || state == CS_FIVE_ONE || state == CS_FIVE_TWO;
+}
+
+// the tick at which a classifier with the controller's debouncing decides,
+// or -1; state is the decision or the last steady output
+template <typename Classify, typename Steady>
+int replay(const Run &run, Classify classify, Steady steady, int debounce_ticks, double &state)
+{
+  double previous = 0.0;
+  double output = 0.0;
+  int count = 0;
+  const double origin = run.position.front();
+  for (size_t i = 0; i < run.position.size(); ++i)
+  {
+    const double current = classify(origin, run.velocity[i], run.position[i], run.force[i]);
+    if (steady(previous, current))
+    {
+      ++count;
+      if (count >= debounce_ticks)
+      {
+        output = current;
+        if (isTerminal(output))
+        {
+          state = output;
+          return static_cast<int>(i);
+        }
+      }
+    }
+    else
+      count = 0;
+    previous = current;
+  }
+  state = output;
+  return -1;
+}
+
+void record(const Run &run, int tick, double state, Score &score)
+{
+  int column = kUndecided;
+  if (tick >= 0)
+    column = static_cast<int>(state);
+  ++score.confusion[run.state][column];
+  if (column == run.state)
+  {
+    const double latency = tick * kTickSeconds;
+    ++score.correct;
+    score.latency_sum += latency;
+    score.latency_max = std::max(score.latency_max, latency);
+  }
+}
+
+Result evaluate(const Candidate &candidate, const std::vector<Run> &runs)
+{
+  const FuzzyLogic::ContactStateClassifier classifier =
+      FuzzyLogic::contactStateClassifier(candidate.velocity, candidate.displacement, candidate.force);
+  Result result;
+  std::memset(&result, 0, sizeof(result));
+
+  for (const Run &run : runs)
+  {
+    double state;
+    int tick = replay(run,
+                      [&](double origin, double v, double z, double f) {
+                        return Criteria::fuzzyLogic(origin, v, z, f, classifier);
+                      },
+                      [](double previous, double current) { return std::fabs(previous - current) < 0.001; }, 20,
+                      state);
+    record(run, tick, state, result.fuzzy);
+
+    // the controller takes the crisp output after more than 20 steady ticks
+    tick = replay(run,
+                  [&](double origin, double v, double z, double f) {
+                    return static_cast<double>(Criteria::crispLogic(origin, v, z, f, candidate.thresholds));
+                  },
+                  [](double previous, double current) { return previous == current; }, 21, state);
+    record(run, tick, state, result.crisp);
+  }
+  return result;
+}
+
+// A file mapped read-only; the dumps are scanned in place instead of being
+// read through a stream.
+class MappedFile
+{
+ public:
+  explicit MappedFile(const std::string &file_name)
+  {
+    const int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+      void *map = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED)
+      {
+        data_ = static_cast<const char *>(map);
+        size_ = status.st_size;
+        ::madvise(map, size_, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd);
+  }
+  ~MappedFile()
+  {
+    if (data_ != nullptr)
+      ::munmap(const_cast<char *>(data_), size_);
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool isOpen() const { return data_ != nullptr; }
+  const char *begin() const { return data_; }
+  const char *end() const { return data_ + size_; }
+
+ private:
+  const char *data_{nullptr};
+  size_t size_{0};
+};
+
+bool loadRun(const std::string &file_name, int state, Run &run)
+{
+  const MappedFile file(file_name);
+  if (!file.isOpen())
+    return false;
+
+  run.file_name = file_name;
+  run.state = state;
+  run.decided = false;
+  run.recorded_fuzzy = run.recorded_crisp = 0.0;
+  bool contact_tick = true;
+  char line[512];
+  for (const char *p = file.begin(); p < file.end();)
+  {
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', file.end() - p));
+    if (eol == nullptr)
+      eol = file.end();
+    const size_t length = std::min(static_cast<size_t>(eol - p), sizeof(line) - 1);
+    std::memcpy(line, p, length);
+    line[length] = '\0';
+    p = eol + 1;
+
+    // status, spiral x, y, velocity, position, force, fuzzy, fuzzy_output_, crisp, crisp_output_
+    int status;
+    double x, y, velocity, position, force, fuzzy, fuzzy_output, crisp, crisp_output;
+    if (std::sscanf(line, "%d %lf %lf %lf %lf %lf %lf %lf %lf %lf", &status, &x, &y, &velocity, &position, &force,
+                    &fuzzy, &fuzzy_output, &crisp, &crisp_output) != 10)
+      continue;
+    if (status == kSearch && contact_tick)
+    {
+      contact_tick = false;
+      continue;
+    }
+    if (status != kSearch)
+    {
+      if (run.position.empty())
+        continue;
+      // the tick that left SEARCH
+      run.decided = true;
+    }
+    run.velocity.push_back(velocity);
+    run.position.push_back(position);
+    run.force.push_back(force);
+    run.recorded_fuzzy = fuzzy_output;
+    run.recorded_crisp = crisp_output;
+    if (run.decided)
+      break;
+  }
+  return !run.position.empty();
+}
+
+Candidate tunedCandidate()
+{
+  Candidate candidate;
+  std::copy(FuzzyLogic::kVelocityBreakpoints, FuzzyLogic::kVelocityBreakpoints + 3, candidate.velocity);
+  std::copy(FuzzyLogic::kDisplacementBreakpoints, FuzzyLogic::kDisplacementBreakpoints + 9, candidate.displacement);
+  std::copy(FuzzyLogic::kForceBreakpoints, FuzzyLogic::kForceBreakpoints + 5, candidate.force);
+  candidate.thresholds = CrispLogic::kContactStateThresholds;
+  return candidate;
+}
+
+template <size_t N>
+void perturb(double (&x)[N], double spread, std::mt19937 &random)
+{
+  std::uniform_real_distribution<double> u(-1.0, 1.0);
+  for (double &value : x)
+    value *= 1.0 + spread * u(random);
+  std::sort(x, x + N);
+}
+
+bool readCandidates(const std::string &file_name, std::vector<Candidate> &candidates)
+{
+  std::ifstream file(file_name);
+  if (!file)
+    return false;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream values(line);
+    Candidate c;
+    for (double &value : c.velocity)
+      values >> value;
+    for (double &value : c.displacement)
+      values >> value;
+    for (double &value : c.force)
+      values >> value;
+    values >> c.thresholds.velocity;
+    for (double &value : c.thresholds.displacement)
+      values >> value;
+    for (double &value : c.thresholds.force)
+      values >> value;
+    if (values)
+      candidates.push_back(c);
+  }
+  return true;
+}
+
+void printArray(const char *name, const double *x, int n)
+{
+  std::printf("  %-13s", name);
+  for (int i = 0; i < n; ++i)
+    std::printf(" %g", x[i]);
+  std::printf("\n");
+}
+
+void printScore(const Score &score, int runs)
+{
+  std::printf("  correct %d / %d, latency mean %.3f s, max %.3f s\n", score.correct, runs, score.meanLatency(),
+              score.latency_max);
+  std::printf("  true \\ decided   0    1    2    3    4  5_1  5_2    -\n");
+  static const char *names[kStates] = {"0", "1", "2", "3", "4", "5_1", "5_2"};
+  for (int s = 0; s < kStates; ++s)
+  {
+    int total = 0;
+    for (int d = 0; d <= kStates; ++d)
+      total += score.confusion[s][d];
+    if (total == 0)
+      continue;
+    std::printf("  %-14s", names[s]);
+    for (int d = 0; d <= kStates; ++d)
+      std::printf(" %4d", score.confusion[s][d]);
+    std::printf("\n");
+  }
+}
+
+bool better(const Score &a, const Score &b)
+{
+  if (a.correct != b.correct)
+    return a.correct > b.correct;
+  return a.meanLatency() < b.meanLatency();
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: contact_state_sweep <manifest> [candidates | candidate file] [spread] [best]\n");
+    return 2;
+  }
+  const double spread = argc > 3 ? std::atof(argv[3]) : 0.2;
+  const int best = argc > 4 ? std::atoi(argv[4]) : 3;
+
+  std::vector<Run> runs;
+  std::ifstream manifest(argv[1]);
+  std::string line;
+  while (std::getline(manifest, line))
+  {
+    std::istringstream fields(line);
+    int state;
+    std::string file_name;
+    if (line.empty() || line[0] == '#' || !(fields >> state >> file_name))
+      continue;
+    Run run;
+    if (state < 0 || state >= kStates || !loadRun(file_name, state, run))
+    {
+      std::fprintf(stderr, "skipping %s\n", line.c_str());
+      continue;
+    }
+    runs.push_back(std::move(run));
+  }
+  if (runs.empty())
+  {
+    std::fprintf(stderr, "no runs in %s\n", argv[1]);
+    return 1;
+  }
+
+  // candidate 0 is the tuned set
+  std::vector<Candidate> candidates(1, tunedCandidate());
+  char *end = nullptr;
+  const long count = argc > 2 ? std::strtol(argv[2], &end, 10) : 1000;
+  if (argc > 2 && *end != '\0')
+  {
+    if (!readCandidates(argv[2], candidates))
+    {
+      std::fprintf(stderr, "cannot read %s\n", argv[2]);
+      return 1;
+    }
+  }
+  else
+  {
+    std::mt19937 random(1);
+    for (long i = 0; i < count; ++i)
+    {
+      Candidate c = tunedCandidate();
+      perturb(c.velocity, spread, random);
+      perturb(c.displacement, spread, random);
+      perturb(c.force, spread, random);
+      c.thresholds.velocity *= 1.0 + spread * std::uniform_real_distribution<double>(-1.0, 1.0)(random);
+      perturb(c.thresholds.displacement, spread, random);
+      perturb(c.thresholds.force, spread, random);
+      candidates.push_back(c);
+    }
+  }
+
+  size_t ticks = 0;
+  for (const Run &run : runs)
+    ticks += run.position.size();
+  const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%zu runs, %zu search ticks, %zu candidates, %u threads\n", runs.size(), ticks, candidates.size(),
+              threads);
+
+  // each worker takes the next candidate until none are left
+  std::vector<Result> results(candidates.size());
+  std::atomic<size_t> next(0);
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t)
+    workers.emplace_back([&]() {
+      for (size_t i = next++; i < candidates.size(); i = next++)
+        results[i] = evaluate(candidates[i], runs);
+    });
+  for (std::thread &worker : workers)
+    worker.join();
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("evaluated in %.2f s (%.1f ns per classification)\n\n", seconds,
+              seconds * 1e9 * threads / (2.0 * candidates.size() * ticks));
+
+  // the replay of the tuned set should decide on the tick and the state the
+  // recorded run did, or stay undecided with it
+  int reproduced = 0;
+  for (const Run &run : runs)
+  {
+    double state;
+    const int tick = replay(run, [](double o, double v, double z, double f) { return Criteria::fuzzyLogic(o, v, z, f); },
+                            [](double previous, double current) { return std::fabs(previous - current) < 0.001; },
+                            20, state);
+    const int last = static_cast<int>(run.position.size()) - 1;
+    if (run.decided ? tick == last && state == run.recorded_fuzzy : tick < 0)
+      ++reproduced;
+  }
+  std::printf("tuned fuzzy decision reproduces the recording in %d / %zu runs\n\n", reproduced, runs.size());
+
+  std::vector<size_t> order(candidates.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  const int shown = std::min<int>(best, order.size());
+
+  for (int crisp = 0; crisp < 2; ++crisp)
+  {
+    const auto score = [&](size_t i) -> const Score & { return crisp ? results[i].crisp : results[i].fuzzy; };
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(),
+                      [&](size_t a, size_t b) { return better(score(a), score(b)); });
+
+    std::printf("%s, tuned:\n", crisp ? "crispLogic" : "fuzzyLogic");
+    printScore(score(0), runs.size());
+    for (int k = 0; k < shown; ++k)
+    {
+      const Candidate &c = candidates[order[k]];
+      std::printf("%s, best %d (candidate %zu):\n", crisp ? "crispLogic" : "fuzzyLogic", k + 1, order[k]);
+      if (crisp)
+      {
+        printArray("velocity", &c.thresholds.velocity, 1);
+        printArray("displacement", c.thresholds.displacement, 4);
+        printArray("force", c.thresholds.force, 2);
+      }
+      else
+      {
+        printArray("velocity", c.velocity, 3);
+        printArray("displacement", c.displacement, 9);
+        printArray("force", c.force, 5);
+      }
+      printScore(score(order[k]), runs.size());
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+// Runs the controllers of this package against SimulatedRobotHW instead of a panda.
+//
+// The loop steps the simulation by a fixed 1 ms per cycle. With ~real_time_factor
+// set to 0 (default) it runs as fast as the controllers allow; /clock is published
+// every cycle so nodes started with use_sim_time follow the simulated time.
+//
+// usage: roslaunch advanced_robotics_franka_controllers franka_sim.launch controller:=<name>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <controller_manager/controller_manager.h>
+#include <ros/ros.h>
+#include <rosgraph_msgs/Clock.h>
+
+#include <advanced_robotics_franka_controllers/simulated_robot_hw.h>
+
+using namespace advanced_robotics_franka_controllers;
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "franka_sim");
+  ros::NodeHandle nh;
+  ros::NodeHandle private_nh("~");
+
+  std::string arm_id;
+  std::vector<std::string> joint_names;
+  std::vector<double> q_init;
+  double real_time_factor;
+  double duration;
+  private_nh.param<std::string>("arm_id", arm_id, "panda");
+  private_nh.param("real_time_factor", real_time_factor, 0.0);
+  private_nh.param("duration", duration, 0.0);
+  if (!private_nh.getParam("joint_names", joint_names) || joint_names.size() != 7)
+  {
+    joint_names.clear();
+    for (int i = 1; i <= 7; ++i)
+      joint_names.push_back(arm_id + "_joint" + std::to_string(i));
+  }
+  if (!private_nh.getParam("q_init", q_init) || q_init.size() != 7)
+    q_init = {0, -M_PI_4, 0, -3 * M_PI_4, 0, M_PI_2, M_PI_4};
+
+  std::array<double, 7> q;
+  std::copy(q_init.begin(), q_init.end(), q.begin());
+  SimulatedRobotHW robot_hw(arm_id, joint_names, q);
+  controller_manager::ControllerManager controller_manager(&robot_hw, nh);
+
+  ros::Publisher clock_pub = nh.advertise<rosgraph_msgs::Clock>("/clock", 1);
+  ros::AsyncSpinner spinner(2);
+  spinner.start();
+
+  const ros::Duration period(0.001);
+  const std::chrono::duration<double> wall_period(period.toSec() / (real_time_factor > 0 ? real_time_factor : 1));
+  ros::Time time(0, 0);
+  rosgraph_msgs::Clock clock;
+  auto wall_next = std::chrono::steady_clock::now();
+  uint64_t ticks = 0;
+  const auto wall_start = std::chrono::steady_clock::now();
+
+  while (ros::ok() && (duration <= 0 || time.toSec() < duration))
+  {
+    time += period;
+    robot_hw.read(time, period);
+    controller_manager.update(time, period);
+    robot_hw.write(time, period);
+
+    clock.clock = time;
+    clock_pub.publish(clock);
+    ++ticks;
+
+    if (real_time_factor > 0)
+    {
+      wall_next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(wall_period);
+      std::this_thread::sleep_until(wall_next);
+    }
+  }
+
+  const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  ROS_INFO_STREAM("franka_sim: " << ticks << " cycles, " << time.toSec() << " s simulated in " << wall
+                  << " s (" << time.toSec() / wall << "x real time)");
+
+  spinner.stop();
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Checks PandaKinematics against the RBDL RobotModel and times both, together
+// with the rotation chain TorqueJointSpaceControllerRRT used to build from
+// seven 3x3 products, on random joint configurations:
+//   - flange pose:           PandaKinematics::flange() vs body 7 * flange offset
+//   - flange jacobian:       PandaKinematics::jacobian() vs RobotModel::getJacobian()
+// and reports the time per tick and the largest differences.
+//
+// usage: rosrun advanced_robotics_franka_controllers kinematics_benchmark [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/panda_kinematics.h>
+#include <advanced_robotics_franka_controllers/robot_model.h>
+
+using namespace advanced_robotics_franka_controllers;
+
+namespace
+{
+template <typename Function>
+double nanosecondsPerSample(const std::vector<PandaKinematics::Vector7d> &samples, int iterations, Function function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    function(samples[i % samples.size()]);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+Eigen::Matrix3d rotateWithY(double angle) { return Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitY()).toRotationMatrix(); }
+Eigen::Matrix3d rotateWithZ(double angle) { return Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ()).toRotationMatrix(); }
+
+// flange in the joint 7 body frame of RobotModel
+const Eigen::Vector3d kFlangeOffset(0.0, 0.0, -PandaKinematics::kD[7]);
+const Eigen::Matrix3d kFlangeRotation = Eigen::Vector3d(1, -1, -1).asDiagonal();
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+  std::srand(1);
+  std::vector<PandaKinematics::Vector7d> samples(256);
+  for (auto &q : samples)
+    q = PandaKinematics::Vector7d::Random() * 2.5;
+
+  RobotModel<7> robot;
+  double sink = 0.0;
+
+  const double chain = nanosecondsPerSample(samples, iterations, [&](const PandaKinematics::Vector7d &q) {
+    const Eigen::Matrix3d rotation = rotateWithZ(q(0)) * rotateWithY(q(1)) * rotateWithZ(q(2)) * rotateWithY(-q(3)) *
+                                     rotateWithZ(q(4)) * rotateWithY(-q(5)) * rotateWithZ(-q(6));
+    sink += rotation(0, 0);
+  });
+
+  const double rbdl = nanosecondsPerSample(samples, iterations, [&](const PandaKinematics::Vector7d &q) {
+    robot.getUpdateKinematics(q, PandaKinematics::Vector7d::Zero());
+    const Transform3d &body = robot.getTransformation(7, Eigen::Vector3d::Zero());
+    sink += body.translation()(0) + robot.getJacobian(7, kFlangeOffset)(0, 0);
+  });
+
+  PandaKinematics::Matrix67d J;
+  const double analytic = nanosecondsPerSample(samples, iterations, [&](const PandaKinematics::Vector7d &q) {
+    const PandaKinematics kinematics(q);
+    kinematics.jacobian(J);
+    sink += kinematics.flangePosition()(0) + J(0, 0);
+  });
+
+  double pose_error = 0.0;
+  double jacobian_error = 0.0;
+  for (const auto &q : samples)
+  {
+    robot.getUpdateKinematics(q, PandaKinematics::Vector7d::Zero());
+    const Transform3d body = robot.getTransformation(7, Eigen::Vector3d::Zero());
+    const Eigen::Vector3d position = body * kFlangeOffset;
+    const Eigen::Matrix3d rotation = body.linear() * kFlangeRotation;
+
+    const PandaKinematics kinematics(q);
+    kinematics.jacobian(J);
+    pose_error = std::max(pose_error, (kinematics.flangePosition() - position).cwiseAbs().maxCoeff());
+    pose_error = std::max(pose_error, (kinematics.flangeRotation() - rotation).cwiseAbs().maxCoeff());
+    jacobian_error = std::max(jacobian_error, (J - robot.getJacobian(7, kFlangeOffset)).cwiseAbs().maxCoeff());
+  }
+
+  std::printf("rotation chain (orientation only): %8.0f ns per tick\n", chain);
+  std::printf("RobotModel pose + jacobian:        %8.0f ns per tick\n", rbdl);
+  std::printf("PandaKinematics pose + jacobian:   %8.0f ns per tick (%.1fx)\n", analytic, rbdl / analytic);
+  std::printf("max pose difference:               %8.2e\n", pose_error);
+  std::printf("max jacobian difference:           %8.2e\n", jacobian_error);
+  std::printf("(checksum %g)\n", sink);
+  return pose_error < 1e-9 && jacobian_error < 1e-9 ? 0 : 1;
+}
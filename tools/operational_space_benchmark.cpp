@@ -0,0 +1,101 @@
+// Compares OperationalSpaceDynamics with the explicit inverses the controllers
+// used before it:
+//   f_sensing = (J M^-1 J^T)^-1 J M^-1 t
+//   lambda    = (J M^-1 J^T)^-1
+//   J_bar     = M^-1 J^T lambda
+//   f         = J_bar^T t
+// on random well conditioned mass matrices and jacobians, and reports the time
+// per tick and the largest wrench difference. Also checks the null space
+// projector N = I - J^T J_bar^T against J_bar formed with M.inverse().
+//
+// usage: rosrun advanced_robotics_franka_controllers operational_space_benchmark [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/operational_space_dynamics.h>
+
+using namespace advanced_robotics_franka_controllers;
+
+namespace
+{
+struct Sample
+{
+  OperationalSpaceDynamics::Matrix7d mass;
+  OperationalSpaceDynamics::Matrix67d jacobian;
+  OperationalSpaceDynamics::Vector7d tau;
+};
+
+template <typename Function>
+double nanosecondsPerSample(const std::vector<Sample> &samples, int iterations, Function function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    function(samples[i % samples.size()]);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+  std::srand(1);
+  std::vector<Sample> samples(256);
+  for (auto &sample : samples)
+  {
+    const OperationalSpaceDynamics::Matrix7d a = OperationalSpaceDynamics::Matrix7d::Random();
+    sample.mass = 0.1 * a * a.transpose() + OperationalSpaceDynamics::Matrix7d::Identity() * 0.05;
+    sample.jacobian = OperationalSpaceDynamics::Matrix67d::Random();
+    sample.tau = OperationalSpaceDynamics::Vector7d::Random() * 10.0;
+  }
+
+  OperationalSpaceDynamics::Vector6d sink = OperationalSpaceDynamics::Vector6d::Zero();
+
+  const double legacy = nanosecondsPerSample(samples, iterations, [&](const Sample &s) {
+    const auto &mass_matrix = s.mass;
+    const auto &jacobian = s.jacobian;
+    Eigen::Matrix<double, 6, 1> f_sensing =
+        (jacobian * mass_matrix.inverse() * jacobian.transpose()).inverse() * jacobian * mass_matrix.inverse() * s.tau;
+    Eigen::Matrix<double, 6, 6> lambda = (jacobian * mass_matrix.inverse() * jacobian.transpose()).inverse();
+    Eigen::Matrix<double, 7, 6> J_bar = mass_matrix.inverse() * jacobian.transpose() * lambda;
+    sink += f_sensing + J_bar.transpose() * s.tau;
+  });
+
+  const double cached = nanosecondsPerSample(samples, iterations, [&](const Sample &s) {
+    OperationalSpaceDynamics op_space(s.mass, s.jacobian);
+    const OperationalSpaceDynamics::Vector6d f = op_space.wrench(s.tau);
+    sink += f + f;
+  });
+
+  double max_error = 0.0;
+  double max_projector_error = 0.0;
+  for (const auto &s : samples)
+  {
+    const OperationalSpaceDynamics::Vector6d reference =
+        (s.jacobian * s.mass.inverse() * s.jacobian.transpose()).inverse() * s.jacobian * s.mass.inverse() * s.tau;
+    const OperationalSpaceDynamics op_space(s.mass, s.jacobian);
+    max_error = std::max(max_error, (op_space.wrench(s.tau) - reference).cwiseAbs().maxCoeff() /
+                                        std::max(1.0, reference.cwiseAbs().maxCoeff()));
+
+    const Eigen::Matrix<double, 7, 7> mass_inverse = s.mass.inverse();
+    const Eigen::Matrix<double, 6, 6> lambda = (s.jacobian * mass_inverse * s.jacobian.transpose()).inverse();
+    const Eigen::Matrix<double, 7, 6> J_bar = mass_inverse * s.jacobian.transpose() * lambda;
+    const Eigen::Matrix<double, 7, 7> projector =
+        Eigen::Matrix<double, 7, 7>::Identity() - s.jacobian.transpose() * J_bar.transpose();
+    max_projector_error = std::max(max_projector_error, (op_space.nullSpaceProjector() - projector).cwiseAbs().maxCoeff() /
+                                                            std::max(1.0, projector.cwiseAbs().maxCoeff()));
+  }
+
+  std::printf("explicit inverses:          %8.0f ns per tick\n", legacy);
+  std::printf("OperationalSpaceDynamics:   %8.0f ns per tick (%.1fx)\n", cached, legacy / cached);
+  std::printf("max relative wrench error:  %8.2e\n", max_error);
+  std::printf("max relative N error:       %8.2e\n", max_projector_error);
+  std::printf("(checksum %g)\n", sink.sum());
+  return 0;
+}
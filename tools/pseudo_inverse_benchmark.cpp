@@ -0,0 +1,115 @@
+// Times the fixed size damped pseudo inverses of damped_pseudo_inverse.h
+// against the expressions they replace on random 6x7 jacobians:
+//   explicit:  J^T (J J^T + 0.001 I)^-1          (task space controllers)
+//   legacy:    pseudoInverse() of pseudo_inversion.h (dynamic size SVD)
+// reports the largest difference to the explicit form, and the joint speed
+// each variant asks for when the jacobian loses rank.
+//
+// usage: rosrun advanced_robotics_franka_controllers pseudo_inverse_benchmark [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/damped_pseudo_inverse.h>
+#include <pseudo_inversion.h>
+
+using namespace advanced_robotics_franka_controllers;
+
+namespace
+{
+typedef Eigen::Matrix<double, 6, 7> Matrix67d;
+typedef Eigen::Matrix<double, 7, 6> Matrix76d;
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+const double kDamping = 0.001;
+
+template <typename Function>
+double nanosecondsPerSample(const std::vector<Matrix67d> &samples, int iterations, Function function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    function(samples[i % samples.size()]);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+Matrix76d explicitInverse(const Matrix67d &J)
+{
+  return J.transpose() * (J * J.transpose() + Eigen::Matrix<double, 6, 6>::Identity() * kDamping).inverse();
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+  std::srand(1);
+  std::vector<Matrix67d> samples(256);
+  for (auto &J : samples)
+    J = Matrix67d::Random();
+
+  Matrix76d J_pinv;
+  double sink = 0.0;
+
+  const double explicit_ns = nanosecondsPerSample(samples, iterations, [&](const Matrix67d &J) {
+    sink += explicitInverse(J)(0, 0);
+  });
+  const double legacy_ns = nanosecondsPerSample(samples, iterations, [&](const Matrix67d &J) {
+    Eigen::MatrixXd pinv;
+    pseudoInverse(J, pinv);
+    sink += pinv(0, 0);
+  });
+  const double ldlt_ns = nanosecondsPerSample(samples, iterations, [&](const Matrix67d &J) {
+    dampedPseudoInverse(J, kDamping, J_pinv);
+    sink += J_pinv(0, 0);
+  });
+  const double svd_ns = nanosecondsPerSample(samples, iterations, [&](const Matrix67d &J) {
+    dampedPseudoInverseSvd(J, kDamping, J_pinv);
+    sink += J_pinv(0, 0);
+  });
+  const double adaptive_ns = nanosecondsPerSample(samples, iterations, [&](const Matrix67d &J) {
+    sink += adaptiveDampedPseudoInverse(J, 0.01, 0.05, J_pinv);
+    sink += J_pinv(0, 0);
+  });
+
+  double ldlt_error = 0.0;
+  double svd_error = 0.0;
+  for (const auto &J : samples)
+  {
+    const Matrix76d reference = explicitInverse(J);
+    dampedPseudoInverse(J, kDamping, J_pinv);
+    ldlt_error = std::max(ldlt_error, (J_pinv - reference).cwiseAbs().maxCoeff());
+    dampedPseudoInverseSvd(J, kDamping, J_pinv);
+    svd_error = std::max(svd_error, (J_pinv - reference).cwiseAbs().maxCoeff());
+  }
+
+  std::printf("explicit inverse:         %8.0f ns\n", explicit_ns);
+  std::printf("pseudoInverse (dynamic):  %8.0f ns\n", legacy_ns);
+  std::printf("dampedPseudoInverse:      %8.0f ns (%.1fx)\n", ldlt_ns, explicit_ns / ldlt_ns);
+  std::printf("dampedPseudoInverseSvd:   %8.0f ns\n", svd_ns);
+  std::printf("adaptive:                 %8.0f ns\n", adaptive_ns);
+  std::printf("max difference ldlt/svd:  %8.2e / %8.2e\n", ldlt_error, svd_error);
+
+  // a wrist singularity: the last row becomes a copy of the fifth one
+  std::printf("\nnear singular, |qd| for a unit task velocity along the lost direction\n");
+  Vector6d xd = Vector6d::Zero();
+  xd(5) = 1.0;
+  for (double distance : {1e-1, 1e-2, 1e-3, 1e-4})
+  {
+    Matrix67d J = samples[0];
+    J.row(5) = J.row(4) + distance * J.row(5).normalized();
+    Matrix76d exact;
+    dampedPseudoInverseSvd(J, 0.0, exact);
+    dampedPseudoInverse(J, kDamping, J_pinv);
+    const double fixed = (J_pinv * xd).norm();
+    const double damping = adaptiveDampedPseudoInverse(J, 0.01, 0.05, J_pinv);
+    std::printf("  distance %6.0e: undamped %10.1f  fixed %8.1f  adaptive %8.1f (damping %.4f)\n", distance,
+                (exact * xd).norm(), fixed, (J_pinv * xd).norm(), damping);
+  }
+  std::printf("(checksum %g)\n", sink);
+  return 0;
+}
@@ -0,0 +1,248 @@
+// Replays a recording made with the record_file controller parameter through a
+// controller's update() as fast as possible.
+//
+// The controller ~controller (an entry of the package config) is loaded through
+// pluginlib. Each tick the recorded robot state and model quantities are served
+// through the franka interfaces and the clock advances by the recorded
+// time stamps, so every run sees the same input. The joint commands are written
+// to ~output (8 doubles per tick: time, 7 commands). If ~reference names the
+// output of an earlier run, the largest command difference is reported.
+//
+// usage: roslaunch advanced_robotics_franka_controllers replay.launch
+//            controller:=<name> recording:=<file> [output:=<file>] [reference:=<file>]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <controller_interface/controller_base.h>
+#include <franka_hw/model_base.h>
+#include <pluginlib/class_loader.h>
+#include <ros/ros.h>
+
+#include <advanced_robotics_franka_controllers/franka_interface_hw.h>
+#include <advanced_robotics_franka_controllers/robot_state_recording.h>
+
+namespace advanced_robotics_franka_controllers
+{
+
+// Serves the model quantities of the current recorded tick.
+class ReplayModel : public franka_hw::ModelBase
+{
+ public:
+  void setTick(const RecordedTick *tick) { tick_ = tick; }
+
+  std::array<double, 16> pose(franka::Frame frame, const std::array<double, 7> &q,
+                              const std::array<double, 16> &F_T_EE,
+                              const std::array<double, 16> &EE_T_K) const override
+  {
+    return tick_->state.O_T_EE;
+  }
+
+  std::array<double, 42> bodyJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                      const std::array<double, 16> &F_T_EE,
+                                      const std::array<double, 16> &EE_T_K) const override
+  {
+    const Eigen::Matrix3d rotation = Eigen::Matrix4d::Map(tick_->state.O_T_EE.data()).topLeftCorner<3, 3>();
+    std::array<double, 42> jacobian = tick_->jacobian;
+    Eigen::Map<Eigen::Matrix<double, 6, 7>> J(jacobian.data());
+    J.topRows<3>() = rotation.transpose() * J.topRows<3>();
+    J.bottomRows<3>() = rotation.transpose() * J.bottomRows<3>();
+    return jacobian;
+  }
+
+  std::array<double, 42> zeroJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                      const std::array<double, 16> &F_T_EE,
+                                      const std::array<double, 16> &EE_T_K) const override
+  {
+    return tick_->jacobian;
+  }
+
+  std::array<double, 49> mass(const std::array<double, 7> &q, const std::array<double, 9> &I_total,
+                              double m_total, const std::array<double, 3> &F_x_Ctotal) const override
+  {
+    return tick_->mass;
+  }
+
+  std::array<double, 7> coriolis(const std::array<double, 7> &q, const std::array<double, 7> &dq,
+                                 const std::array<double, 9> &I_total, double m_total,
+                                 const std::array<double, 3> &F_x_Ctotal) const override
+  {
+    return tick_->coriolis;
+  }
+
+  std::array<double, 7> gravity(const std::array<double, 7> &q, double m_total,
+                                const std::array<double, 3> &F_x_Ctotal,
+                                const std::array<double, 3> &gravity_earth) const override
+  {
+    return tick_->gravity;
+  }
+
+ private:
+  const RecordedTick *tick_{nullptr};
+};
+
+class ReplayRobotHW : public FrankaInterfaceHW
+{
+ public:
+  ReplayRobotHW(const std::string &arm_id, const std::vector<std::string> &joint_names, const RecordedTick &first)
+  {
+    load(first);
+    position_command_ = robot_state_.q;
+    registerInterfaces(arm_id, joint_names, model_);
+  }
+
+  void load(const RecordedTick &tick)
+  {
+    model_.setTick(&tick);
+    fromRecordedState(tick.state, robot_state_);
+  }
+
+ private:
+  ReplayModel model_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
+
+using namespace advanced_robotics_franka_controllers;
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "replay");
+  ros::NodeHandle root_nh;
+  ros::NodeHandle private_nh("~");
+
+  std::string name;
+  std::string recording_file;
+  std::string output_file;
+  std::string reference_file;
+  private_nh.getParam("controller", name);
+  private_nh.getParam("recording", recording_file);
+  private_nh.getParam("output", output_file);
+  private_nh.getParam("reference", reference_file);
+
+  RobotStateRecording recording;
+  if (!recording.open(recording_file) || recording.size() == 0)
+  {
+    ROS_ERROR_STREAM("replay: no ticks in " << recording_file);
+    return 1;
+  }
+
+  ros::NodeHandle controller_nh(root_nh, name);
+  std::string type;
+  std::string arm_id;
+  std::vector<std::string> joint_names;
+  if (!controller_nh.getParam("type", type) || !controller_nh.getParam("arm_id", arm_id) ||
+      !controller_nh.getParam("joint_names", joint_names) || joint_names.size() != 7)
+  {
+    ROS_ERROR_STREAM("replay: " << name << " has no type, arm_id or joint_names parameters");
+    return 1;
+  }
+  // never record the replay itself
+  controller_nh.deleteParam("record_file");
+
+  pluginlib::ClassLoader<controller_interface::ControllerBase> loader("controller_interface",
+                                                                      "controller_interface::ControllerBase");
+  ReplayRobotHW robot_hw(arm_id, joint_names, recording[0]);
+  std::unique_ptr<controller_interface::ControllerBase> controller;
+  try
+  {
+    controller.reset(loader.createUnmanagedInstance(type));
+  }
+  catch (pluginlib::PluginlibException &ex)
+  {
+    ROS_ERROR_STREAM("replay: could not load " << type << ": " << ex.what());
+    return 1;
+  }
+
+  controller_interface::ControllerBase::ClaimedResources claimed_resources;
+  if (!controller->initRequest(&robot_hw, root_nh, controller_nh, claimed_resources))
+  {
+    ROS_ERROR_STREAM("replay: " << name << " init failed");
+    return 1;
+  }
+
+  const std::array<double, 7> *command = &robot_hw.effortCommand();
+  for (const auto &resource : claimed_resources)
+  {
+    if (resource.hardware_interface == "hardware_interface::PositionJointInterface")
+      command = &robot_hw.positionCommand();
+    else if (resource.hardware_interface == "hardware_interface::VelocityJointInterface")
+      command = &robot_hw.velocityCommand();
+  }
+
+  std::vector<double> output;
+  output.reserve(recording.size() * 8);
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  controller->startRequest(ros::Time().fromNSec(recording[0].time_ns));
+  for (size_t i = 0; i < recording.size(); ++i)
+  {
+    const RecordedTick &tick = recording[i];
+    robot_hw.load(tick);
+    const ros::Time time = ros::Time().fromNSec(tick.time_ns);
+    controller->updateRequest(time, ros::Duration().fromNSec(tick.period_ns));
+
+    output.push_back(time.toSec());
+    output.insert(output.end(), command->begin(), command->end());
+  }
+  const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  controller->stopRequest(ros::Time().fromNSec(recording[recording.size() - 1].time_ns));
+
+  const double recorded = (recording[recording.size() - 1].time_ns - recording[0].time_ns) * 1e-9;
+  ROS_INFO_STREAM("replay: " << recording.size() << " ticks in " << wall << " s, "
+                  << wall / recording.size() * 1e6 << " us per update, " << recorded / wall << "x real time");
+
+  if (!output_file.empty())
+  {
+    FILE *file = fopen(output_file.c_str(), "wb");
+    if (file == nullptr)
+    {
+      ROS_ERROR_STREAM("replay: could not write " << output_file);
+      return 1;
+    }
+    fwrite(output.data(), sizeof(double), output.size(), file);
+    fclose(file);
+  }
+
+  if (!reference_file.empty())
+  {
+    FILE *file = fopen(reference_file.c_str(), "rb");
+    if (file == nullptr)
+    {
+      ROS_ERROR_STREAM("replay: could not read " << reference_file);
+      return 1;
+    }
+    std::vector<double> reference(output.size());
+    const size_t count = fread(reference.data(), sizeof(double), reference.size(), file);
+    fclose(file);
+    if (count != output.size())
+      ROS_WARN_STREAM("replay: reference has " << count / 8 << " ticks, replay has " << output.size() / 8);
+
+    double max_error = 0.0;
+    size_t first_tick = count / 8;
+    for (size_t i = 0; i < count / 8; ++i)
+    {
+      for (size_t j = 1; j < 8; ++j)
+      {
+        const double error = std::abs(output[i * 8 + j] - reference[i * 8 + j]);
+        if (error > 1e-9 && first_tick == count / 8)
+          first_tick = i;
+        max_error = std::max(max_error, error);
+      }
+    }
+    if (first_tick < count / 8)
+      ROS_WARN_STREAM("replay: commands differ from tick " << first_tick << ", max difference " << max_error);
+    else
+      ROS_INFO("replay: commands match the reference");
+    return first_tick < count / 8 ? 2 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Checks solveDiscreteRiccati against the Hamiltonian eigenvector solution
+// the old DyrosMath::discreteRiccatiEquation computed, on random stabilizable
+// systems, and times both:
+//   eigenvectors:  dynamic size 2n x 2n EigenSolver (the old implementation)
+//   doubling:      solveDiscreteRiccati<4, 2>
+// reports the largest relative difference and the largest residual of the
+// Riccati equation.
+//
+// usage: rosrun advanced_robotics_franka_controllers riccati_benchmark [systems]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/discrete_riccati.h>
+
+using namespace advanced_robotics_franka_controllers;
+
+namespace
+{
+typedef Eigen::Matrix<double, 4, 4> Matrix4d;
+typedef Eigen::Matrix<double, 4, 2> Matrix42d;
+
+// X = U21 U11^-1 from the eigenvectors of the symplectic matrix with
+// eigenvalues outside the unit circle
+Eigen::MatrixXd hamiltonianSolution(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B, const Eigen::MatrixXd &R,
+                                    const Eigen::MatrixXd &Q)
+{
+  const int n = A.rows();
+  const Eigen::MatrixXd A_inv = A.inverse();
+  const Eigen::MatrixXd G = B * R.inverse() * B.transpose();
+  Eigen::MatrixXd Z(2 * n, 2 * n);
+  Z << A_inv, A_inv * G, Q * A_inv, A.transpose() + Q * A_inv * G;
+
+  const Eigen::EigenSolver<Eigen::MatrixXd> eigen(Z);
+  Eigen::MatrixXcd U(2 * n, n);
+  for (int i = 0, c = 0; i < 2 * n && c < n; ++i)
+    if (std::abs(eigen.eigenvalues()(i)) > 1.0)
+      U.col(c++) = eigen.eigenvectors().col(i);
+  return (U.bottomRows(n) * U.topRows(n).inverse()).real();
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const int systems = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  std::srand(1);
+  double legacy_us = 0.0;
+  double doubling_us = 0.0;
+  double difference = 0.0;
+  double residual = 0.0;
+  int failures = 0;
+  double sink = 0.0;
+
+  for (int k = 0; k < systems; ++k)
+  {
+    // spectral radius 1.3, so about half of the systems are open loop unstable
+    Matrix4d A = Matrix4d::Random();
+    A *= 1.3 / A.eigenvalues().cwiseAbs().maxCoeff();
+    const Matrix42d B = Matrix42d::Random();
+    Matrix4d Q = Matrix4d::Random();
+    Q = Q * Q.transpose() + Matrix4d::Identity();
+    const Eigen::Matrix2d R = Eigen::Matrix2d::Identity() * 0.5;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Eigen::MatrixXd X_legacy = hamiltonianSolution(A, B, R, Q);
+    const auto middle = std::chrono::steady_clock::now();
+    Matrix4d X;
+    if (!solveDiscreteRiccati(A, B, Q, R, X))
+      ++failures;
+    const auto end = std::chrono::steady_clock::now();
+    legacy_us += std::chrono::duration<double, std::micro>(middle - start).count();
+    doubling_us += std::chrono::duration<double, std::micro>(end - middle).count();
+    sink += X(0, 0) + X_legacy(0, 0);
+
+    const double scale = X.cwiseAbs().maxCoeff();
+    difference = std::max(difference, (X - X_legacy).cwiseAbs().maxCoeff() / scale);
+    const Matrix4d riccati = A.transpose() * X * A -
+                             A.transpose() * X * B * (R + B.transpose() * X * B).inverse() * B.transpose() * X * A +
+                             Q - X;
+    residual = std::max(residual, riccati.cwiseAbs().maxCoeff() / scale);
+  }
+
+  std::printf("eigenvectors (dynamic):   %8.1f us\n", legacy_us / systems);
+  std::printf("doubling (4 x 4, 2 in):   %8.1f us (%.1fx)\n", doubling_us / systems, legacy_us / doubling_us);
+  std::printf("max relative difference:  %8.2e\n", difference);
+  std::printf("max relative residual:    %8.2e\n", residual);
+  std::printf("not converged:            %8d\n", failures);
+  std::printf("(checksum %g)\n", sink);
+  return failures == 0 && residual < 1e-9 ? 0 : 1;
+}
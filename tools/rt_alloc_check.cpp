@@ -0,0 +1,286 @@
+// Checks that controller update() loops do not touch the heap.
+//
+// Every controller listed in ~controllers is loaded through pluginlib, initialized
+// against stand-in franka hardware and updated for ~ticks cycles. malloc/free are
+// interposed and every allocation or release made inside update() is reported
+// with a backtrace (pipe through c++filt for readable names).
+//
+// usage: roslaunch advanced_robotics_franka_controllers rt_alloc_check.launch
+//
+// Controllers that wait for the franka_gripper action servers in init() need
+// those servers running.
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <execinfo.h>
+#include <malloc.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <controller_interface/controller_base.h>
+#include <franka/robot_state.h>
+#include <franka_hw/model_base.h>
+#include <pluginlib/class_loader.h>
+#include <ros/ros.h>
+
+#include <advanced_robotics_franka_controllers/franka_interface_hw.h>
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+namespace
+{
+
+thread_local bool tracking = false;
+thread_local bool in_hook = false;
+
+size_t allocations = 0;
+size_t releases = 0;
+size_t reports = 0;
+size_t max_reports = 5;
+
+void report(const char *what, size_t size)
+{
+  if (!tracking || in_hook)
+    return;
+  in_hook = true;
+
+  if (size > 0)
+    ++allocations;
+  else
+    ++releases;
+
+  if (reports < max_reports)
+  {
+    ++reports;
+    void *frames[32];
+    const int depth = backtrace(frames, 32);
+    dprintf(STDERR_FILENO, "  %s %zu bytes in update():\n", what, size);
+    backtrace_symbols_fd(frames + 2, depth - 2, STDERR_FILENO);
+  }
+  in_hook = false;
+}
+
+}  // namespace
+
+extern "C" void *malloc(size_t size)
+{
+  report("malloc", size);
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+  report("calloc", count * size);
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+  report("realloc", size);
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size)
+{
+  report("memalign", size);
+  return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+  report("posix_memalign", size);
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr == nullptr ? ENOMEM : 0;
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size)
+{
+  report("aligned_alloc", size);
+  return __libc_memalign(alignment, size);
+}
+
+extern "C" void free(void *ptr)
+{
+  if (ptr != nullptr)
+    report("free", 0);
+  __libc_free(ptr);
+}
+
+namespace advanced_robotics_franka_controllers
+{
+
+// Constant, well conditioned model values: enough to drive every branch of the
+// controllers' update() without a robot connection.
+class StandInModel : public franka_hw::ModelBase
+{
+ public:
+  std::array<double, 16> pose(franka::Frame frame, const std::array<double, 7> &q,
+                              const std::array<double, 16> &F_T_EE,
+                              const std::array<double, 16> &EE_T_K) const override
+  {
+    return {{1, 0, 0, 0, 0, -1, 0, 0, 0, 0, -1, 0, 0.307, 0, 0.487, 1}};
+  }
+
+  std::array<double, 42> bodyJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                      const std::array<double, 16> &F_T_EE,
+                                      const std::array<double, 16> &EE_T_K) const override
+  {
+    return jacobian();
+  }
+
+  std::array<double, 42> zeroJacobian(franka::Frame frame, const std::array<double, 7> &q,
+                                      const std::array<double, 16> &F_T_EE,
+                                      const std::array<double, 16> &EE_T_K) const override
+  {
+    return jacobian();
+  }
+
+  std::array<double, 49> mass(const std::array<double, 7> &q, const std::array<double, 9> &I_total,
+                              double m_total, const std::array<double, 3> &F_x_Ctotal) const override
+  {
+    std::array<double, 49> mass{};
+    for (size_t i = 0; i < 7; ++i)
+      mass[i * 7 + i] = 1.0;
+    return mass;
+  }
+
+  std::array<double, 7> coriolis(const std::array<double, 7> &q, const std::array<double, 7> &dq,
+                                 const std::array<double, 9> &I_total, double m_total,
+                                 const std::array<double, 3> &F_x_Ctotal) const override
+  {
+    return {};
+  }
+
+  std::array<double, 7> gravity(const std::array<double, 7> &q, double m_total,
+                                const std::array<double, 3> &F_x_Ctotal,
+                                const std::array<double, 3> &gravity_earth) const override
+  {
+    return {};
+  }
+
+ private:
+  static std::array<double, 42> jacobian()
+  {
+    std::array<double, 42> jacobian{};
+    for (size_t i = 0; i < 6; ++i)
+      jacobian[i * 6 + i] = 1.0;
+    return jacobian;
+  }
+};
+
+class StandInRobotHW : public FrankaInterfaceHW
+{
+ public:
+  StandInRobotHW(const std::string &arm_id, const std::vector<std::string> &joint_names)
+  {
+    robot_state_.q = {{0, -M_PI_4, 0, -3 * M_PI_4, 0, M_PI_2, M_PI_4}};
+    robot_state_.q_d = robot_state_.q;
+    robot_state_.O_T_EE = model_.pose(franka::Frame::kEndEffector, robot_state_.q, robot_state_.F_T_EE,
+                                      robot_state_.EE_T_K);
+    robot_state_.O_T_EE_d = robot_state_.O_T_EE;
+    position_command_ = robot_state_.q;
+    registerInterfaces(arm_id, joint_names, model_);
+  }
+
+ private:
+  StandInModel model_;
+};
+
+}  // namespace advanced_robotics_franka_controllers
+
+using namespace advanced_robotics_franka_controllers;
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "rt_alloc_check");
+  ros::NodeHandle root_nh;
+  ros::NodeHandle private_nh("~");
+
+  std::vector<std::string> controllers;
+  int ticks;
+  int report_limit;
+  private_nh.getParam("controllers", controllers);
+  private_nh.param("ticks", ticks, 1000);
+  private_nh.param("max_reports", report_limit, 5);
+  max_reports = report_limit;
+
+  // backtrace() loads libgcc on its first call, which allocates
+  void *frames[1];
+  backtrace(frames, 1);
+
+  pluginlib::ClassLoader<controller_interface::ControllerBase> loader("controller_interface",
+                                                                      "controller_interface::ControllerBase");
+  const ros::Duration period(0.001);
+  int failed = 0;
+
+  for (const auto &name : controllers)
+  {
+    ros::NodeHandle controller_nh(root_nh, name);
+    std::string type;
+    std::string arm_id;
+    std::vector<std::string> joint_names;
+    if (!controller_nh.getParam("type", type) || !controller_nh.getParam("arm_id", arm_id) ||
+        !controller_nh.getParam("joint_names", joint_names) || joint_names.size() != 7)
+    {
+      ROS_ERROR_STREAM(name << ": missing type, arm_id or joint_names parameters");
+      ++failed;
+      continue;
+    }
+
+    StandInRobotHW robot_hw(arm_id, joint_names);
+    std::unique_ptr<controller_interface::ControllerBase> controller;
+    try
+    {
+      controller.reset(loader.createUnmanagedInstance(type));
+    }
+    catch (pluginlib::PluginlibException &ex)
+    {
+      ROS_ERROR_STREAM(name << ": could not load " << type << ": " << ex.what());
+      ++failed;
+      continue;
+    }
+
+    controller_interface::ControllerBase::ClaimedResources claimed_resources;
+    if (!controller->initRequest(&robot_hw, root_nh, controller_nh, claimed_resources))
+    {
+      ROS_ERROR_STREAM(name << ": init failed");
+      ++failed;
+      continue;
+    }
+
+    ros::Time time = ros::Time::now();
+    controller->startRequest(time);
+
+    allocations = 0;
+    releases = 0;
+    reports = 0;
+    size_t dirty_ticks = 0;
+    fprintf(stderr, "%s (%s)\n", name.c_str(), type.c_str());
+    for (int i = 0; i < ticks; ++i)
+    {
+      time += period;
+      const size_t before = allocations + releases;
+      tracking = true;
+      controller->updateRequest(time, period);
+      tracking = false;
+      if (allocations + releases != before)
+        ++dirty_ticks;
+    }
+    controller->stopRequest(time);
+
+    fprintf(stderr, "%s: %zu allocations, %zu frees in %zu of %d updates\n", name.c_str(), allocations, releases,
+            dirty_ticks, ticks);
+    if (dirty_ticks > 0)
+      ++failed;
+  }
+
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// Times the 7 joint homing trajectory the controllers evaluate every tick:
+//   scalar:     DyrosMath::cubic + cubicDot per joint (the old loop)
+//   segment:    MultiCubicSegment<7> built and evaluated in update()
+//   prebuilt:   MultiCubicSegment<7> built once, evaluated per tick
+// and reports the largest difference to the scalar path.
+//
+// usage: rosrun advanced_robotics_franka_controllers trajectory_benchmark [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <advanced_robotics_franka_controllers/trajectory_segment.h>
+#include "math_type_define.h"
+
+using namespace advanced_robotics_franka_controllers;
+
+namespace
+{
+typedef Eigen::Matrix<double, 7, 1> Vector7d;
+
+const double kStart = 10.0;
+const double kDuration = 3.0;
+
+template <typename Function>
+double nanosecondsPerTick(int iterations, Function function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    function(kStart + kDuration * (i % 1000) / 1000.0);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  std::srand(1);
+  const Vector7d q_init = Vector7d::Random();
+  const Vector7d q_goal = Vector7d::Random();
+  Vector7d q_desired, qd_desired;
+  double sink = 0.0;
+
+  const double scalar = nanosecondsPerTick(iterations, [&](double time) {
+    for (int i = 0; i < 7; i++)
+    {
+      q_desired(i) = DyrosMath::cubic(time, kStart, kStart + kDuration, q_init(i), q_goal(i), 0, 0);
+      qd_desired(i) = DyrosMath::cubicDot(time, kStart, kStart + kDuration, q_init(i), q_goal(i), 0, 0);
+    }
+    sink += q_desired(0) + qd_desired(6);
+  });
+
+  const double segment = nanosecondsPerTick(iterations, [&](double time) {
+    const MultiCubicSegment<7> homing(kStart, kStart + kDuration, q_init, q_goal);
+    const MultiTrajectoryPoint<7> desired = homing.evaluate(time);
+    sink += desired.position(0) + desired.velocity(6);
+  });
+
+  const MultiCubicSegment<7> homing(kStart, kStart + kDuration, q_init, q_goal);
+  const double prebuilt = nanosecondsPerTick(iterations, [&](double time) {
+    const MultiTrajectoryPoint<7> desired = homing.evaluate(time);
+    sink += desired.position(0) + desired.velocity(6);
+  });
+
+  double error = 0.0;
+  for (double time = kStart - 0.5; time < kStart + kDuration + 0.5; time += 0.001)
+  {
+    const MultiTrajectoryPoint<7> desired = homing.evaluate(time);
+    for (int i = 0; i < 7; i++)
+    {
+      error = std::max(error, std::abs(desired.position(i) -
+                                       DyrosMath::cubic(time, kStart, kStart + kDuration, q_init(i), q_goal(i), 0, 0)));
+      error = std::max(error, std::abs(desired.velocity(i) - DyrosMath::cubicDot(time, kStart, kStart + kDuration,
+                                                                                 q_init(i), q_goal(i), 0, 0)));
+    }
+  }
+
+  std::printf("scalar cubic + cubicDot: %7.1f ns per tick\n", scalar);
+  std::printf("MultiCubicSegment:       %7.1f ns per tick (%.1fx)\n", segment, scalar / segment);
+  std::printf("  prebuilt:              %7.1f ns per tick (%.1fx)\n", prebuilt, scalar / prebuilt);
+  std::printf("max difference:          %7.2e\n", error);
+  std::printf("(checksum %g)\n", sink);
+  return 0;
+}